@@ -8,7 +8,7 @@ int main() {
   if (!buried) {
     return -1;
   }
-  BuriedConfig config;
+  BuriedConfig config = {};
   config.host = "localhost";
   config.port = "5678";
   config.topic = "test_topic";
@@ -27,7 +27,7 @@ int main() {
 
   std::thread t2([&]() {
     for (int i = 0; i < 100; ++i) {
-      Buried_Report(buried, "test_2title", "test_2data", i);
+      Buried_ReportN(buried, "test_2title", 11, "test_2data", 10, i);
       std::this_thread::sleep_for(std::chrono::milliseconds(500));
     }
   });
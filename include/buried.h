@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define BURIED_EXPORT __declspec(dllexport)
@@ -8,6 +9,11 @@ extern "C" {
 
 typedef struct Buried Buried;
 
+// 结构化事件构造器，由 Buried_EventBegin 创建，
+// 由 Buried_EventCommit 或 Buried_EventCancel 释放
+typedef struct BuriedEventBuilder BuriedEventBuilder;
+
+// 未使用的字段需要清零（例如 BuriedConfig config = {};），0 表示默认值
 struct BuriedConfig {
   const char* host;
   const char* port;
@@ -16,6 +22,31 @@ struct BuriedConfig {
   const char* app_version;
   const char* app_name;
   const char* custom_data;
+
+  // 内存队列容量，0 为 8192
+  uint32_t ring_capacity;
+  // 内存队列写满时：0 丢弃新事件，1 阻塞调用方直到有空位，
+  // 2 队首事件优先级更低时淘汰队首
+  int32_t overflow_policy;
+  // 本地数据库：0 均衡，1 每次提交都落盘，2 吞吐优先（掉电可能丢失最近数据）
+  int32_t storage_profile;
+  // 请求体压缩：0 不压缩，1 gzip，2 deflate，需要服务端支持
+  int32_t compression;
+  // 新数据的加密算法：0 AES-256-CBC，1 AES-256-GCM
+  int32_t cipher;
+  // 新数据的密钥 id
+  int32_t key_id;
+  // 非 0 时上报请求体整体加密，需要服务端支持
+  int32_t encrypt_body;
+};
+
+// 一条埋点事件，title 和 data 按长度传入，不要求以 '\0' 结尾
+struct BuriedEvent {
+  const char* title;
+  size_t title_len;
+  const char* data;
+  size_t data_len;
+  uint32_t priority;
 };
 
 BURIED_EXPORT Buried* Buried_Create(const char* work_dir);
@@ -24,6 +55,52 @@ BURIED_EXPORT void Buried_Destroy(Buried* buried);
 
 BURIED_EXPORT int32_t Buried_Start(Buried* buried, BuriedConfig* config);
 
+// 上报函数返回 0 表示成功，1 表示参数不合法，
+// 2 表示队列已满、事件按 overflow_policy 被丢弃
 BURIED_EXPORT int32_t Buried_Report(Buried* buried, const char* title,
                                     const char* data, uint32_t priority);
+
+// 按长度传入 title 和 data，不要求以 '\0' 结尾，也不需要 strlen。
+// 长度为 0 时对应的指针可以为 NULL
+BURIED_EXPORT int32_t Buried_ReportN(Buried* buried, const char* title,
+                                     size_t title_len, const char* data,
+                                     size_t data_len, uint32_t priority);
+
+// 批量上报 count 个事件，整批只进入一次队列，落库在同一个事务中。
+// 任一事件参数不合法时整批都不上报
+BURIED_EXPORT int32_t Buried_ReportBatch(Buried* buried,
+                                         const BuriedEvent* events,
+                                         size_t count);
+
+// 开始构造一个结构化事件，之后用 Buried_EventAdd* 添加属性。
+// 属性直接编码成 JSON 对象作为事件的 data，不需要调用方先序列化。
+// 标题、key 和字符串值应为 UTF-8，非法的字节序列会被替换为 U+FFFD。
+// 参数不合法时返回 NULL
+BURIED_EXPORT BuriedEventBuilder* Buried_EventBegin(Buried* buried,
+                                                    const char* title,
+                                                    size_t title_len,
+                                                    uint32_t priority);
+
+BURIED_EXPORT int32_t Buried_EventAddInt(BuriedEventBuilder* builder,
+                                         const char* key, size_t key_len,
+                                         int64_t value);
+
+BURIED_EXPORT int32_t Buried_EventAddDouble(BuriedEventBuilder* builder,
+                                            const char* key, size_t key_len,
+                                            double value);
+
+BURIED_EXPORT int32_t Buried_EventAddBool(BuriedEventBuilder* builder,
+                                          const char* key, size_t key_len,
+                                          int32_t value);
+
+BURIED_EXPORT int32_t Buried_EventAddString(BuriedEventBuilder* builder,
+                                            const char* key, size_t key_len,
+                                            const char* value,
+                                            size_t value_len);
+
+// 上报构造好的事件并释放 builder
+BURIED_EXPORT int32_t Buried_EventCommit(BuriedEventBuilder* builder);
+
+// 放弃构造的事件并释放 builder
+BURIED_EXPORT void Buried_EventCancel(BuriedEventBuilder* builder);
 }
\ No newline at end of file
@@ -1,5 +1,38 @@
+use std::io::Read;
+
+use flate2::read::{GzDecoder, ZlibDecoder};
 use tiny_http::{Response, Server};
 
+// 取出请求的 Content-Encoding，没有时为空
+fn content_encoding(request: &tiny_http::Request) -> String {
+    request
+        .headers()
+        .iter()
+        .find(|header| header.field.equiv("Content-Encoding"))
+        .map(|header| header.value.as_str().trim().to_ascii_lowercase())
+        .unwrap_or_default()
+}
+
+// 按 Content-Encoding 解压请求体
+fn decode_body(encoding: String, body: &[u8]) -> std::io::Result<String> {
+    let mut content = String::new();
+    match encoding.as_str() {
+        "gzip" => GzDecoder::new(body).read_to_string(&mut content)?,
+        "deflate" => ZlibDecoder::new(body).read_to_string(&mut content)?,
+        "" | "identity" => {
+            let mut reader = body;
+            reader.read_to_string(&mut content)?
+        }
+        _ => {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::Unsupported,
+                format!("unsupported content encoding: {}", encoding),
+            ))
+        }
+    };
+    Ok(content)
+}
+
 #[tokio::main]
 async fn main() -> std::io::Result<()> {
     println!("Hello, Buried!");
@@ -15,19 +48,41 @@ async fn main() -> std::io::Result<()> {
             request.headers()
         );
 
-        match request.method() {
+        // 请求体无法解码时返回错误码，客户端保留这批数据等待重试
+        let status: u16 = match request.method() {
             tiny_http::Method::Post => {
-                let mut content = String::new();
-                request.as_reader().read_to_string(&mut content).unwrap();
-                println!("content: {}", content);
+                let mut body = Vec::new();
+                match request.as_reader().read_to_end(&mut body) {
+                    Err(e) => {
+                        println!("read body error: {}", e);
+                        400
+                    }
+                    Ok(_) => match decode_body(content_encoding(&request), &body) {
+                        Ok(content) => {
+                            println!("content ({} bytes on wire): {}", body.len(), content);
+                            200
+                        }
+                        Err(e) => {
+                            println!("decode body error: {}", e);
+                            if e.kind() == std::io::ErrorKind::Unsupported {
+                                415
+                            } else {
+                                400
+                            }
+                        }
+                    },
+                }
             }
 
             _ => {
                 println!("not a post request");
+                200
             }
-        }
+        };
 
-        let response = Response::from_string("{\"code\": 0}");
+        let code = if status == 200 { 0 } else { 1 };
+        let response =
+            Response::from_string(format!("{{\"code\": {}}}", code)).with_status_code(status);
         let _ = request.respond(response);
     }
 
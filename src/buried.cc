@@ -3,6 +3,17 @@
 #include <iostream>
 
 #include "buried_core.h"
+#include "report/event_builder.h"
+
+struct BuriedEventBuilder {
+  Buried* buried;
+  buried::EventBuilder builder;
+};
+
+// 指针为空时长度必须为 0
+static bool ValidBuffer(const char* buffer, size_t length) {
+  return buffer || length == 0;
+}
 
 extern "C" {
 
@@ -45,6 +56,13 @@ int32_t Buried_Start(Buried* buried, BuriedConfig* config) {
   if (config->custom_data) {
     buried_config.custom_data = config->custom_data;
   }
+  buried_config.ring_capacity = config->ring_capacity;
+  buried_config.overflow_policy = config->overflow_policy;
+  buried_config.storage_profile = config->storage_profile;
+  buried_config.compression = config->compression;
+  buried_config.cipher = config->cipher;
+  buried_config.key_id = config->key_id;
+  buried_config.encrypt_body = config->encrypt_body != 0;
   return buried->Start(buried_config);
 }
 
@@ -55,4 +73,90 @@ int32_t Buried_Report(Buried* buried, const char* title, const char* data,
   }
   return buried->Report(title, data, priority);
 }
+
+int32_t Buried_ReportN(Buried* buried, const char* title, size_t title_len,
+                       const char* data, size_t data_len, uint32_t priority) {
+  if (!buried || !ValidBuffer(title, title_len) ||
+      !ValidBuffer(data, data_len)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  // 调用方的缓冲区只在这里复制一次，之后一直移动到编码
+  return buried->Report(std::string(title ? title : "", title_len),
+                        std::string(data ? data : "", data_len), priority);
+}
+
+int32_t Buried_ReportBatch(Buried* buried, const BuriedEvent* events,
+                           size_t count) {
+  if (!buried || (!events && count)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const BuriedEvent& event = events[i];
+    if (!ValidBuffer(event.title, event.title_len) ||
+        !ValidBuffer(event.data, event.data_len)) {
+      return BuriedResult::kBuriedInvalidParam;
+    }
+  }
+  return buried->ReportBatch(events, count);
+}
+
+BuriedEventBuilder* Buried_EventBegin(Buried* buried, const char* title,
+                                      size_t title_len, uint32_t priority) {
+  if (!buried || !ValidBuffer(title, title_len)) {
+    return nullptr;
+  }
+  return new BuriedEventBuilder{
+      buried, buried::EventBuilder(std::string(title ? title : "", title_len),
+                                   priority)};
+}
+
+int32_t Buried_EventAddInt(BuriedEventBuilder* builder, const char* key,
+                           size_t key_len, int64_t value) {
+  if (!builder || !ValidBuffer(key, key_len)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  builder->builder.AddInt(std::string_view(key, key_len), value);
+  return BuriedResult::kBuriedOk;
+}
+
+int32_t Buried_EventAddDouble(BuriedEventBuilder* builder, const char* key,
+                              size_t key_len, double value) {
+  if (!builder || !ValidBuffer(key, key_len)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  builder->builder.AddDouble(std::string_view(key, key_len), value);
+  return BuriedResult::kBuriedOk;
+}
+
+int32_t Buried_EventAddBool(BuriedEventBuilder* builder, const char* key,
+                            size_t key_len, int32_t value) {
+  if (!builder || !ValidBuffer(key, key_len)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  builder->builder.AddBool(std::string_view(key, key_len), value != 0);
+  return BuriedResult::kBuriedOk;
+}
+
+int32_t Buried_EventAddString(BuriedEventBuilder* builder, const char* key,
+                              size_t key_len, const char* value,
+                              size_t value_len) {
+  if (!builder || !ValidBuffer(key, key_len) ||
+      !ValidBuffer(value, value_len)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  builder->builder.AddString(std::string_view(key, key_len),
+                             std::string_view(value, value_len));
+  return BuriedResult::kBuriedOk;
+}
+
+int32_t Buried_EventCommit(BuriedEventBuilder* builder) {
+  if (!builder) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
+  int32_t ret = builder->buried->ReportData(builder->builder.Finish());
+  delete builder;
+  return ret;
+}
+
+void Buried_EventCancel(BuriedEventBuilder* builder) { delete builder; }
 }
\ No newline at end of file
@@ -3,5 +3,6 @@
 enum BuriedResult {
   kBuriedOk = 0,
   kBuriedInvalidParam = 1,
+  kBuriedDropped = 2,  // 队列已满，事件按溢出策略被丢弃
   kBuriedUnknown = -1,
 };
\ No newline at end of file
@@ -47,7 +47,78 @@ Buried::Buried(const std::string& work_dir) {
 
 Buried::~Buried() {}
 
+// 把 C 接口的取值转换为上报参数，取值不合法时返回 false
+static bool MakeReportConfig(const Buried::Config& config,
+                             buried::BuriedReportConfig& report_config) {
+  if (config.ring_capacity != 0) {
+    report_config.ring_capacity = config.ring_capacity;
+  }
+  switch (config.overflow_policy) {
+    case 0:
+      report_config.overflow_policy = buried::OverflowPolicy::kDrop;
+      break;
+    case 1:
+      report_config.overflow_policy = buried::OverflowPolicy::kBlock;
+      break;
+    case 2:
+      report_config.overflow_policy =
+          buried::OverflowPolicy::kOverwriteLowestPriority;
+      break;
+    default:
+      return false;
+  }
+  switch (config.storage_profile) {
+    case 0:
+      report_config.storage_profile =
+          buried::BuriedDb::StorageProfile::kBalanced;
+      break;
+    case 1:
+      report_config.storage_profile =
+          buried::BuriedDb::StorageProfile::kDurable;
+      break;
+    case 2:
+      report_config.storage_profile =
+          buried::BuriedDb::StorageProfile::kThroughput;
+      break;
+    default:
+      return false;
+  }
+  switch (config.compression) {
+    case 0:
+      report_config.compression.encoding = buried::HttpEncoding::kIdentity;
+      break;
+    case 1:
+      report_config.compression.encoding = buried::HttpEncoding::kGzip;
+      break;
+    case 2:
+      report_config.compression.encoding = buried::HttpEncoding::kDeflate;
+      break;
+    default:
+      return false;
+  }
+  switch (config.cipher) {
+    case 0:
+      report_config.cipher = buried::CipherMode::kAesCbc;
+      break;
+    case 1:
+      report_config.cipher = buried::CipherMode::kAesGcm;
+      break;
+    default:
+      return false;
+  }
+  if (config.key_id < 0) {
+    return false;
+  }
+  report_config.key_id = config.key_id;
+  report_config.encrypt_body = config.encrypt_body;
+  return true;
+}
+
 BuriedResult Buried::Start(const Config& config) {
+  buried::BuriedReportConfig report_config;
+  if (!MakeReportConfig(config, report_config)) {
+    return BuriedResult::kBuriedInvalidParam;
+  }
   buried::CommonService common_service;
   common_service.host = config.host;
   common_service.port = config.port;
@@ -58,7 +129,7 @@ BuriedResult Buried::Start(const Config& config) {
   common_service.custom_data = nlohmann::json::parse(config.custom_data);
 
   buried_report_ = std::make_unique<buried::BuriedReport>(
-      logger_, std::move(common_service), work_path_.string());
+      logger_, std::move(common_service), work_path_.string(), report_config);
   buried_report_->Start();
   return BuriedResult::kBuriedOk;
 }
@@ -69,6 +140,30 @@ BuriedResult Buried::Report(std::string title, std::string data,
   buried_data.title = std::move(title);
   buried_data.data = std::move(data);
   buried_data.priority = priority;
-  buried_report_->InsertData(buried_data);
-  return BuriedResult::kBuriedOk;
+  return buried_report_->InsertData(std::move(buried_data))
+             ? BuriedResult::kBuriedOk
+             : BuriedResult::kBuriedDropped;
+}
+
+BuriedResult Buried::ReportData(buried::BuriedData&& data) {
+  return buried_report_->InsertData(std::move(data))
+             ? BuriedResult::kBuriedOk
+             : BuriedResult::kBuriedDropped;
+}
+
+BuriedResult Buried::ReportBatch(const BuriedEvent* events, size_t count) {
+  std::vector<buried::BuriedData> datas(count);
+  for (size_t i = 0; i < count; ++i) {
+    const BuriedEvent& event = events[i];
+    if (event.title_len) {
+      datas[i].title.assign(event.title, event.title_len);
+    }
+    if (event.data_len) {
+      datas[i].data.assign(event.data, event.data_len);
+    }
+    datas[i].priority = event.priority;
+  }
+  return buried_report_->InsertDatas(std::move(datas))
+             ? BuriedResult::kBuriedOk
+             : BuriedResult::kBuriedDropped;
 }
\ No newline at end of file
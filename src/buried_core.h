@@ -15,6 +15,7 @@ class logger;
 
 namespace buried {
 class BuriedReport;
+struct BuriedData;
 }
 
 struct Buried {
@@ -27,6 +28,15 @@ struct Buried {
     std::string app_version;
     std::string app_name;
     std::string custom_data;
+
+    // 上报参数，取值含义见 BuriedConfig，0 表示默认值
+    uint32_t ring_capacity = 0;
+    int32_t overflow_policy = 0;
+    int32_t storage_profile = 0;
+    int32_t compression = 0;
+    int32_t cipher = 0;
+    int32_t key_id = 0;
+    bool encrypt_body = false;
   };
 
  public:
@@ -38,6 +48,10 @@ struct Buried {
 
   BuriedResult Report(std::string title, std::string data, uint32_t priority);
 
+  BuriedResult ReportBatch(const BuriedEvent* events, size_t count);
+
+  BuriedResult ReportData(buried::BuriedData&& data);
+
  public:
   std::shared_ptr<spdlog::logger> Logger();
 
@@ -128,9 +128,18 @@ std::string CommonService::GetProcessTime() {
 }
 
 // 获取当前系统时间
+// 上报数据在多个计算线程上生成，不能使用返回静态缓冲区的 ctime
 std::string CommonService::GetNowDate() {
-  auto t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-  return std::ctime(&t);
+  return GetDate(std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count());
+}
+
+std::string CommonService::GetDate(int64_t timestamp_ms) {
+  time_t t = static_cast<time_t>(timestamp_ms / 1000);
+  char buf[64] = {0};
+  ctime_s(buf, sizeof(buf), &t);
+  return buf;
 }
 
 // 生成 32 位随机字符串ID
@@ -141,9 +150,9 @@ std::string CommonService::GetRandomId() {
       "0123456789"
       "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
       "abcdefghijklmnopqrstuvwxyz";
-  // 初始化随机数生成器
-  static std::mt19937_64 rng{std::random_device{}()};
-  static std::uniform_int_distribution<size_t> dist{0, 60};
+  // 初始化随机数生成器，每个线程各自一份，多个计算线程可以同时调用
+  static thread_local std::mt19937_64 rng{std::random_device{}()};
+  static thread_local std::uniform_int_distribution<size_t> dist{0, 60};
   
   std::string result;
   result.reserve(len);
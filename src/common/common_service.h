@@ -32,6 +32,9 @@ struct CommonService {
 
   static std::string GetNowDate();
 
+  // 把毫秒时间戳格式化为与 GetNowDate 相同格式的本地时间
+  static std::string GetDate(int64_t timestamp_ms);
+
   static std::string GetRandomId();
 
  private:
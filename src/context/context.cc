@@ -1,7 +1,15 @@
 #include "context/context.h"
 
+#include <algorithm>
+
 namespace buried {
 
+// 计算线程数：留出主线程和上报线程，最多 4 个
+static size_t WorkerThreadCount() {
+  size_t cores = std::thread::hardware_concurrency();
+  return std::clamp<size_t>(cores > 2 ? cores - 2 : 1, 1, 4);
+}
+
 void Context::Start() {
   if (is_start_.load()) {
     return;
@@ -24,16 +32,35 @@ void Context::Start() {
       report_context_.run();
     }
   });
+  for (size_t i = 0; i < WorkerThreadCount(); ++i) {
+    worker_threads_.emplace_back([this]() {
+      for (;;) {
+        if (is_stop_) {
+          break;
+        }
+        worker_context_.run();
+      }
+    });
+  }
 }
 
 Context::~Context() {
   is_stop_ = true;
+  main_work_guard_.reset();
+  report_work_guard_.reset();
+  worker_work_guard_.reset();
+  main_context_.stop();
+  report_context_.stop();
+  worker_context_.stop();
   if (main_thread_) {
     main_thread_->join();
   }
   if (report_thread_) {
     report_thread_->join();
   }
+  for (auto& worker : worker_threads_) {
+    worker.join();
+  }
 }
 
 }  // namespace buried
\ No newline at end of file
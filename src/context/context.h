@@ -3,7 +3,9 @@
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <vector>
 
+#include "boost/asio/executor_work_guard.hpp"
 #include "boost/asio/io_context.hpp"
 #include "boost/asio/io_context_strand.hpp"
 
@@ -24,6 +26,7 @@ class Context {
   // 类型别名，方便外部使用
   using Strand = boost::asio::io_context::strand;
   using IOContext = boost::asio::io_context;
+  using WorkGuard = boost::asio::executor_work_guard<IOContext::executor_type>;
 
   // 获取主逻辑的 strand（用于保证主逻辑任务的串行执行）
   Strand& GetMainStrand() { return main_strand_; }
@@ -34,12 +37,24 @@ class Context {
   // 获取主逻辑的 io_context
   IOContext& GetMainContext() { return main_context_; }
 
+  // 获取上报逻辑的 io_context
+  IOContext& GetReportContext() { return report_context_; }
+
+  // 获取计算任务（序列化、加解密、压缩）的 io_context，由多个线程并行执行，
+  // 投递到这里的任务之间没有顺序保证
+  IOContext& GetWorkerContext() { return worker_context_; }
+
   // 启动主线程和上报线程，运行 io_context
   void Start();
 
  private:
   // 构造函数，初始化 strand，分别绑定到各自的 io_context
-  Context() : main_strand_(main_context_), report_strand_(report_context_) {}
+  Context()
+      : main_strand_(main_context_),
+        report_strand_(report_context_),
+        main_work_guard_(main_context_.get_executor()),
+        report_work_guard_(report_context_.get_executor()),
+        worker_work_guard_(worker_context_.get_executor()) {}
 
   // 禁止拷贝构造和赋值，保证单例唯一性
   Context(const Context&) = delete;
@@ -48,12 +63,19 @@ class Context {
  private:
   boost::asio::io_context main_context_;   // 主逻辑的 io_context
   boost::asio::io_context report_context_; // 上报逻辑的 io_context
+  boost::asio::io_context worker_context_; // 计算任务的 io_context
 
   boost::asio::io_context::strand main_strand_;   // 主逻辑串行器
   boost::asio::io_context::strand report_strand_; // 上报逻辑串行器
 
+  // 保持 io_context 有未完成的工作，避免没有任务时 run() 直接返回并进入停止状态
+  WorkGuard main_work_guard_;
+  WorkGuard report_work_guard_;
+  WorkGuard worker_work_guard_;
+
   std::unique_ptr<std::thread> main_thread_;   // 主逻辑线程
   std::unique_ptr<std::thread> report_thread_; // 上报逻辑线程
+  std::vector<std::thread> worker_threads_;    // 计算任务线程
 
   std::atomic<bool> is_start_{false}; // 标记是否已启动
   std::atomic<bool> is_stop_{false};  // 标记是否已停止
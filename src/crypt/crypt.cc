@@ -3,7 +3,10 @@
 #include <string>
 
 #include "third_party/mbedtls/include/mbedtls/cipher.h"
+#include "third_party/mbedtls/include/mbedtls/ctr_drbg.h"
+#include "third_party/mbedtls/include/mbedtls/entropy.h"
 #include "third_party/mbedtls/include/mbedtls/error.h"
+#include "third_party/mbedtls/include/mbedtls/gcm.h"
 #include "third_party/mbedtls/include/mbedtls/md.h"
 #include "third_party/mbedtls/include/mbedtls/pkcs5.h"
 
@@ -37,15 +40,19 @@ std::string AESCrypt::GetKey(const std::string& salt,
 class AESImpl {
  public:
   // 构造函数，初始化加解密上下文
-  explicit AESImpl(const std::string& key) { Init(key.data(), key.size()); }
+  explicit AESImpl(const std::string& key) {
+    ready_ = Init(key.data(), key.size());
+  }
 
   ~AESImpl() { UnInit(); } // 析构时释放资源
 
   AESImpl(const AESImpl& other) = delete;
   AESImpl& operator=(const AESImpl& other) = delete;
 
-  // 初始化加解密上下文
-  void Init(const char* key, size_t key_size);
+  // 初始化加解密上下文，任何一步失败都返回 false
+  bool Init(const char* key, size_t key_size);
+
+  bool Ready() const { return ready_; }
 
   // 释放加解密上下文
   void UnInit();
@@ -56,6 +63,21 @@ class AESImpl {
   // 解密接口
   std::string Decrypt(const void* input, size_t input_size);
 
+  // 加密到调用方提供的缓冲区，output_size 至少为 input_size + 块大小
+  bool EncryptInto(const unsigned char* input, size_t input_size,
+                   unsigned char* output, size_t output_size, size_t& written);
+
+  // 解密到调用方提供的缓冲区，output_size 至少为 input_size + 块大小
+  bool DecryptInto(const unsigned char* input, size_t input_size,
+                   unsigned char* output, size_t output_size, size_t& written);
+
+ private:
+  // 用指定上下文执行一次完整的 CBC 加密或解密
+  static bool Crypt_(mbedtls_cipher_context_t& ctx, const unsigned char* iv,
+                     size_t block_size, const unsigned char* input,
+                     size_t input_size, unsigned char* output,
+                     size_t output_size, size_t& written);
+
  private:
   mbedtls_cipher_context_t encrypt_ctx_; // 加密上下文
   mbedtls_cipher_context_t decrypt_ctx_; // 解密上下文
@@ -64,31 +86,47 @@ class AESImpl {
   uint32_t decrypt_block_size_ = 0; // 解密块大小
 
   unsigned char iv_[16] = {0}; // 初始向量（全0，实际应用建议随机）
+  bool ready_ = false;         // 密钥是否设置成功
 };
 
-// 初始化加解密上下文
-void AESImpl::Init(const char* key, size_t key_size) {
-  // 初始化加密上下文
+// 初始化加解密上下文。密钥长度不对（例如派生失败得到空密钥）时
+// setkey 失败，之后的加解密都返回失败，不会用未设置的密钥加密
+bool AESImpl::Init(const char* key, size_t key_size) {
   mbedtls_cipher_init(&encrypt_ctx_);
-  mbedtls_cipher_setup(
-      &encrypt_ctx_, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_256_CBC));
-  mbedtls_cipher_set_padding_mode(&encrypt_ctx_, MBEDTLS_PADDING_PKCS7);
-  mbedtls_cipher_setkey(&encrypt_ctx_,
-                        reinterpret_cast<const unsigned char*>(key),
-                        key_size * 8, MBEDTLS_ENCRYPT); // 设置密钥（位数）
+  mbedtls_cipher_init(&decrypt_ctx_);
 
+  // 初始化加密上下文
+  int ret = mbedtls_cipher_setup(
+      &encrypt_ctx_, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_256_CBC));
+  if (ret == 0) {
+    ret = mbedtls_cipher_set_padding_mode(&encrypt_ctx_, MBEDTLS_PADDING_PKCS7);
+  }
+  if (ret == 0) {
+    ret = mbedtls_cipher_setkey(&encrypt_ctx_,
+                                reinterpret_cast<const unsigned char*>(key),
+                                key_size * 8, MBEDTLS_ENCRYPT); // 设置密钥（位数）
+  }
+  if (ret != 0) {
+    return false;
+  }
   encrypt_block_size_ = mbedtls_cipher_get_block_size(&encrypt_ctx_);
 
   // 初始化解密上下文
-  mbedtls_cipher_init(&decrypt_ctx_);
-  mbedtls_cipher_setup(
+  ret = mbedtls_cipher_setup(
       &decrypt_ctx_, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_256_CBC));
-  mbedtls_cipher_set_padding_mode(&decrypt_ctx_, MBEDTLS_PADDING_PKCS7);
-  mbedtls_cipher_setkey(&decrypt_ctx_,
-                        reinterpret_cast<const unsigned char*>(key),
-                        key_size * 8, MBEDTLS_DECRYPT);
-
+  if (ret == 0) {
+    ret = mbedtls_cipher_set_padding_mode(&decrypt_ctx_, MBEDTLS_PADDING_PKCS7);
+  }
+  if (ret == 0) {
+    ret = mbedtls_cipher_setkey(&decrypt_ctx_,
+                                reinterpret_cast<const unsigned char*>(key),
+                                key_size * 8, MBEDTLS_DECRYPT);
+  }
+  if (ret != 0) {
+    return false;
+  }
   decrypt_block_size_ = mbedtls_cipher_get_block_size(&decrypt_ctx_);
+  return true;
 }
 
 // 释放加解密上下文资源
@@ -99,54 +137,74 @@ void AESImpl::UnInit() {
 
 // 加密实现
 std::string AESImpl::Encrypt(const void* input, size_t input_size) {
-  mbedtls_cipher_set_iv(&encrypt_ctx_, iv_, sizeof(iv_)); // 设置初始向量
-  mbedtls_cipher_reset(&encrypt_ctx_);                    // 重置上下文
-
   std::string output(input_size + encrypt_block_size_, 0); // 预分配输出缓冲区
-  size_t olen = 0;
-  // 加密数据
-  int ret = mbedtls_cipher_update(
-      &encrypt_ctx_, reinterpret_cast<const unsigned char*>(input), input_size,
-      reinterpret_cast<unsigned char*>(output.data()), &olen);
-  if (ret != 0) {
+  size_t written = 0;
+  if (!EncryptInto(reinterpret_cast<const unsigned char*>(input), input_size,
+                   reinterpret_cast<unsigned char*>(output.data()),
+                   output.size(), written)) {
     return ""; // 失败返回空
   }
-  size_t olen2 = 0;
-  // 结束加密，处理填充
-  ret = mbedtls_cipher_finish(
-      &encrypt_ctx_, reinterpret_cast<unsigned char*>(output.data()) + olen,
-      &olen2);
-  if (ret != 0) {
-    return "";
-  }
-  output.resize(olen + olen2); // 调整输出长度
+  output.resize(written); // 调整输出长度
   return output;
 }
 
 // 解密实现
 std::string AESImpl::Decrypt(const void* input, size_t input_size) {
-  mbedtls_cipher_set_iv(&decrypt_ctx_, iv_, sizeof(iv_)); // 设置初始向量
-  mbedtls_cipher_reset(&decrypt_ctx_);                    // 重置上下文
-
   std::string output(input_size + decrypt_block_size_, 0); // 预分配输出缓冲区
+  size_t written = 0;
+  if (!DecryptInto(reinterpret_cast<const unsigned char*>(input), input_size,
+                   reinterpret_cast<unsigned char*>(output.data()),
+                   output.size(), written)) {
+    return "";
+  }
+  output.resize(written); // 调整输出长度
+  return output;
+}
+
+bool AESImpl::EncryptInto(const unsigned char* input, size_t input_size,
+                          unsigned char* output, size_t output_size,
+                          size_t& written) {
+  if (!ready_) {
+    return false;
+  }
+  return Crypt_(encrypt_ctx_, iv_, encrypt_block_size_, input, input_size,
+                output, output_size, written);
+}
+
+bool AESImpl::DecryptInto(const unsigned char* input, size_t input_size,
+                          unsigned char* output, size_t output_size,
+                          size_t& written) {
+  if (!ready_) {
+    return false;
+  }
+  return Crypt_(decrypt_ctx_, iv_, decrypt_block_size_, input, input_size,
+                output, output_size, written);
+}
+
+bool AESImpl::Crypt_(mbedtls_cipher_context_t& ctx, const unsigned char* iv,
+                     size_t block_size, const unsigned char* input,
+                     size_t input_size, unsigned char* output,
+                     size_t output_size, size_t& written) {
+  // mbedtls 要求输出缓冲区比输入至少多一个块
+  if (output_size < input_size + block_size) {
+    return false;
+  }
+  mbedtls_cipher_set_iv(&ctx, iv, 16); // 设置初始向量
+  mbedtls_cipher_reset(&ctx);          // 重置上下文
+
   size_t olen = 0;
-  // 解密数据
-  int ret = mbedtls_cipher_update(
-      &decrypt_ctx_, reinterpret_cast<const unsigned char*>(input), input_size,
-      reinterpret_cast<unsigned char*>(output.data()), &olen);
+  int ret = mbedtls_cipher_update(&ctx, input, input_size, output, &olen);
   if (ret != 0) {
-    return "";
+    return false;
   }
   size_t olen2 = 0;
-  // 结束解密，处理填充
-  ret = mbedtls_cipher_finish(
-      &decrypt_ctx_, reinterpret_cast<unsigned char*>(output.data()) + olen,
-      &olen2);
+  // 结束加解密，处理填充
+  ret = mbedtls_cipher_finish(&ctx, output + olen, &olen2);
   if (ret != 0) {
-    return "";
+    return false;
   }
-  output.resize(olen + olen2); // 调整输出长度
-  return output;
+  written = olen + olen2;
+  return true;
 }
 
 // AESCrypt 构造与析构，持有 AESImpl 实例
@@ -155,6 +213,8 @@ AESCrypt::AESCrypt(const std::string& key)
 
 AESCrypt::~AESCrypt() {}
 
+bool AESCrypt::Ready() const { return impl_->Ready(); }
+
 // 加密字符串接口
 std::string AESCrypt::Encrypt(const std::string& input) {
   return impl_->Encrypt(input.data(), input.size());
@@ -175,4 +235,443 @@ std::string AESCrypt::Decrypt(const void* input, size_t input_size) {
   return impl_->Decrypt(input, input_size);
 }
 
+size_t AESCrypt::EncryptedSize(size_t input_size) const {
+  return input_size + 16;
+}
+
+size_t AESCrypt::DecryptedSize(size_t input_size) const {
+  return input_size + 16;
+}
+
+bool AESCrypt::EncryptInto(std::span<const std::byte> input,
+                           std::span<std::byte> output, size_t& written) {
+  return impl_->EncryptInto(
+      reinterpret_cast<const unsigned char*>(input.data()), input.size(),
+      reinterpret_cast<unsigned char*>(output.data()), output.size(),
+      written);
+}
+
+bool AESCrypt::DecryptInto(std::span<const std::byte> input,
+                           std::span<std::byte> output, size_t& written) {
+  return impl_->DecryptInto(
+      reinterpret_cast<const unsigned char*>(input.data()), input.size(),
+      reinterpret_cast<unsigned char*>(output.data()), output.size(),
+      written);
+}
+
+// AES-GCM 实现类，每个实例有自己的随机数生成器，用于产生 nonce
+class AESGCMImpl {
+ public:
+  explicit AESGCMImpl(const std::string& key);
+
+  ~AESGCMImpl();
+
+  AESGCMImpl(const AESGCMImpl& other) = delete;
+  AESGCMImpl& operator=(const AESGCMImpl& other) = delete;
+
+  std::string Encrypt(const void* input, size_t input_size);
+
+  std::string Decrypt(const void* input, size_t input_size);
+
+  bool EncryptInto(const unsigned char* input, size_t input_size,
+                   unsigned char* output, size_t output_size, size_t& written);
+
+  bool DecryptInto(const unsigned char* input, size_t input_size,
+                   unsigned char* output, size_t output_size, size_t& written);
+
+  bool Ready() const { return ready_; }
+
+ private:
+  mbedtls_gcm_context gcm_ctx_;
+  mbedtls_entropy_context entropy_;
+  mbedtls_ctr_drbg_context drbg_;
+  bool ready_ = false;  // 密钥和随机数生成器是否初始化成功
+};
+
+// CTR_DRBG 只在构造时从系统熵源取一次种子，之后生成 nonce 不再有系统调用
+AESGCMImpl::AESGCMImpl(const std::string& key) {
+  mbedtls_gcm_init(&gcm_ctx_);
+  mbedtls_entropy_init(&entropy_);
+  mbedtls_ctr_drbg_init(&drbg_);
+  static const char kPersonalization[] = "buried_gcm_nonce";
+  int ret = mbedtls_ctr_drbg_seed(
+      &drbg_, mbedtls_entropy_func, &entropy_,
+      reinterpret_cast<const unsigned char*>(kPersonalization),
+      sizeof(kPersonalization) - 1);
+  if (ret != 0) {
+    return;
+  }
+  ret = mbedtls_gcm_setkey(&gcm_ctx_, MBEDTLS_CIPHER_ID_AES,
+                           reinterpret_cast<const unsigned char*>(key.data()),
+                           static_cast<unsigned int>(key.size() * 8));
+  ready_ = ret == 0;
+}
+
+AESGCMImpl::~AESGCMImpl() {
+  mbedtls_gcm_free(&gcm_ctx_);
+  mbedtls_ctr_drbg_free(&drbg_);
+  mbedtls_entropy_free(&entropy_);
+}
+
+std::string AESGCMImpl::Encrypt(const void* input, size_t input_size) {
+  std::string output(AESGCMCrypt::kNonceSize + input_size +
+                         AESGCMCrypt::kTagSize,
+                     0);
+  size_t written = 0;
+  if (!EncryptInto(reinterpret_cast<const unsigned char*>(input), input_size,
+                   reinterpret_cast<unsigned char*>(output.data()),
+                   output.size(), written)) {
+    return "";
+  }
+  return output;
+}
+
+std::string AESGCMImpl::Decrypt(const void* input, size_t input_size) {
+  if (input_size < AESGCMCrypt::kNonceSize + AESGCMCrypt::kTagSize) {
+    return "";
+  }
+  std::string output(
+      input_size - AESGCMCrypt::kNonceSize - AESGCMCrypt::kTagSize, 0);
+  size_t written = 0;
+  if (!DecryptInto(reinterpret_cast<const unsigned char*>(input), input_size,
+                   reinterpret_cast<unsigned char*>(output.data()),
+                   output.size(), written)) {
+    return "";
+  }
+  return output;
+}
+
+bool AESGCMImpl::EncryptInto(const unsigned char* input, size_t input_size,
+                             unsigned char* output, size_t output_size,
+                             size_t& written) {
+  size_t total =
+      AESGCMCrypt::kNonceSize + input_size + AESGCMCrypt::kTagSize;
+  if (!ready_ || output_size < total) {
+    return false;
+  }
+  unsigned char* nonce = output;
+  unsigned char* cipher_text = nonce + AESGCMCrypt::kNonceSize;
+  unsigned char* tag = cipher_text + input_size;
+  if (mbedtls_ctr_drbg_random(&drbg_, nonce, AESGCMCrypt::kNonceSize) != 0) {
+    return false;
+  }
+  int ret = mbedtls_gcm_crypt_and_tag(
+      &gcm_ctx_, MBEDTLS_GCM_ENCRYPT, input_size, nonce,
+      AESGCMCrypt::kNonceSize, nullptr, 0, input, cipher_text,
+      AESGCMCrypt::kTagSize, tag);
+  if (ret != 0) {
+    return false;
+  }
+  written = total;
+  return true;
+}
+
+bool AESGCMImpl::DecryptInto(const unsigned char* input, size_t input_size,
+                             unsigned char* output, size_t output_size,
+                             size_t& written) {
+  if (!ready_ ||
+      input_size < AESGCMCrypt::kNonceSize + AESGCMCrypt::kTagSize) {
+    return false;
+  }
+  size_t text_size =
+      input_size - AESGCMCrypt::kNonceSize - AESGCMCrypt::kTagSize;
+  if (output_size < text_size) {
+    return false;
+  }
+  const unsigned char* nonce = input;
+  const unsigned char* cipher_text = nonce + AESGCMCrypt::kNonceSize;
+  const unsigned char* tag = cipher_text + text_size;
+  // tag 校验失败说明密钥不对或数据被篡改
+  int ret = mbedtls_gcm_auth_decrypt(
+      &gcm_ctx_, text_size, nonce, AESGCMCrypt::kNonceSize, nullptr, 0, tag,
+      AESGCMCrypt::kTagSize, cipher_text, output);
+  if (ret != 0) {
+    return false;
+  }
+  written = text_size;
+  return true;
+}
+
+AESGCMCrypt::AESGCMCrypt(const std::string& key)
+    : impl_(std::make_unique<AESGCMImpl>(key)) {}
+
+AESGCMCrypt::~AESGCMCrypt() {}
+
+bool AESGCMCrypt::Ready() const { return impl_->Ready(); }
+
+std::string AESGCMCrypt::Encrypt(const std::string& input) {
+  return impl_->Encrypt(input.data(), input.size());
+}
+
+std::string AESGCMCrypt::Decrypt(const std::string& input) {
+  return impl_->Decrypt(input.data(), input.size());
+}
+
+std::string AESGCMCrypt::Encrypt(const void* input, size_t input_size) {
+  return impl_->Encrypt(input, input_size);
+}
+
+std::string AESGCMCrypt::Decrypt(const void* input, size_t input_size) {
+  return impl_->Decrypt(input, input_size);
+}
+
+size_t AESGCMCrypt::EncryptedSize(size_t input_size) const {
+  return kNonceSize + input_size + kTagSize;
+}
+
+size_t AESGCMCrypt::DecryptedSize(size_t input_size) const {
+  return input_size > kNonceSize + kTagSize
+             ? input_size - kNonceSize - kTagSize
+             : 0;
+}
+
+bool AESGCMCrypt::EncryptInto(std::span<const std::byte> input,
+                              std::span<std::byte> output, size_t& written) {
+  return impl_->EncryptInto(
+      reinterpret_cast<const unsigned char*>(input.data()), input.size(),
+      reinterpret_cast<unsigned char*>(output.data()), output.size(),
+      written);
+}
+
+bool AESGCMCrypt::DecryptInto(std::span<const std::byte> input,
+                              std::span<std::byte> output, size_t& written) {
+  return impl_->DecryptInto(
+      reinterpret_cast<const unsigned char*>(input.data()), input.size(),
+      reinterpret_cast<unsigned char*>(output.data()), output.size(),
+      written);
+}
+
+// CBC 使用 mbedtls 的通用 cipher 层，它自己缓存不满一块的输入和解密时的最后一块；
+// GCM 直接使用 gcm 的流式接口，nonce 和 tag 在这里处理
+class CipherStream::Impl {
+ public:
+  Impl(CipherMode mode, const std::string& key, CipherDirection direction)
+      : mode_(mode), encrypt_(direction == CipherDirection::kEncrypt) {
+    const auto* data = reinterpret_cast<const unsigned char*>(key.data());
+    int bits = static_cast<int>(key.size() * 8);
+    if (mode_ == CipherMode::kAesCbc) {
+      mbedtls_cipher_init(&cbc_ctx_);
+      int ret = mbedtls_cipher_setup(
+          &cbc_ctx_, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_256_CBC));
+      if (ret == 0) {
+        ret = mbedtls_cipher_set_padding_mode(&cbc_ctx_, MBEDTLS_PADDING_PKCS7);
+      }
+      if (ret == 0) {
+        ret = mbedtls_cipher_setkey(
+            &cbc_ctx_, data, bits,
+            encrypt_ ? MBEDTLS_ENCRYPT : MBEDTLS_DECRYPT);
+      }
+      ready_ = ret == 0;
+    } else if (mode_ == CipherMode::kAesGcm) {
+      mbedtls_gcm_init(&gcm_ctx_);
+      ready_ = mbedtls_gcm_setkey(&gcm_ctx_, MBEDTLS_CIPHER_ID_AES, data,
+                                  static_cast<unsigned int>(bits)) == 0;
+      if (ready_ && encrypt_) {
+        mbedtls_entropy_init(&entropy_);
+        mbedtls_ctr_drbg_init(&drbg_);
+        has_drbg_ = true;
+        static const char kPersonalization[] = "buried_gcm_stream";
+        ready_ = mbedtls_ctr_drbg_seed(
+                     &drbg_, mbedtls_entropy_func, &entropy_,
+                     reinterpret_cast<const unsigned char*>(kPersonalization),
+                     sizeof(kPersonalization) - 1) == 0;
+      }
+    }
+  }
+
+  ~Impl() {
+    if (mode_ == CipherMode::kAesCbc) {
+      mbedtls_cipher_free(&cbc_ctx_);
+    } else if (mode_ == CipherMode::kAesGcm) {
+      mbedtls_gcm_free(&gcm_ctx_);
+      if (has_drbg_) {
+        mbedtls_ctr_drbg_free(&drbg_);
+        mbedtls_entropy_free(&entropy_);
+      }
+    }
+  }
+
+  bool Begin(std::string& out) {
+    started_ = false;
+    gcm_started_ = false;
+    pending_.clear();
+    if (!ready_) {
+      return false;
+    }
+    if (mode_ == CipherMode::kAesCbc) {
+      unsigned char iv[16] = {0};  // 与 AESCrypt 相同的全 0 初始向量
+      started_ = mbedtls_cipher_set_iv(&cbc_ctx_, iv, sizeof(iv)) == 0 &&
+                 mbedtls_cipher_reset(&cbc_ctx_) == 0;
+      return started_;
+    }
+    if (!encrypt_) {
+      // 解密时 nonce 在密文开头，收到后才能开始
+      started_ = true;
+      return true;
+    }
+    unsigned char nonce[AESGCMCrypt::kNonceSize];
+    if (mbedtls_ctr_drbg_random(&drbg_, nonce, sizeof(nonce)) != 0 ||
+        mbedtls_gcm_starts(&gcm_ctx_, MBEDTLS_GCM_ENCRYPT, nonce,
+                           sizeof(nonce)) != 0) {
+      return false;
+    }
+    out.append(reinterpret_cast<const char*>(nonce), sizeof(nonce));
+    gcm_started_ = true;
+    started_ = true;
+    return true;
+  }
+
+  bool Update(const unsigned char* input, size_t input_size,
+              std::string& out) {
+    if (!started_) {
+      return false;
+    }
+    if (mode_ == CipherMode::kAesCbc) {
+      return CbcUpdate_(input, input_size, out);
+    }
+    if (encrypt_) {
+      return GcmUpdate_(input, input_size, out);
+    }
+    // 解密：先凑齐 nonce，之后始终保留最后 kTagSize 字节，它们可能是 tag
+    pending_.append(reinterpret_cast<const char*>(input), input_size);
+    if (!gcm_started_) {
+      if (pending_.size() < AESGCMCrypt::kNonceSize) {
+        return true;
+      }
+      if (mbedtls_gcm_starts(
+              &gcm_ctx_, MBEDTLS_GCM_DECRYPT,
+              reinterpret_cast<const unsigned char*>(pending_.data()),
+              AESGCMCrypt::kNonceSize) != 0) {
+        return false;
+      }
+      pending_.erase(0, AESGCMCrypt::kNonceSize);
+      gcm_started_ = true;
+    }
+    if (pending_.size() <= AESGCMCrypt::kTagSize) {
+      return true;
+    }
+    size_t ready = pending_.size() - AESGCMCrypt::kTagSize;
+    if (!GcmUpdate_(reinterpret_cast<const unsigned char*>(pending_.data()),
+                    ready, out)) {
+      return false;
+    }
+    pending_.erase(0, ready);
+    return true;
+  }
+
+  bool Finish(std::string& out) {
+    if (!started_) {
+      return false;
+    }
+    started_ = false;
+    if (mode_ == CipherMode::kAesCbc) {
+      size_t mark = out.size();
+      out.resize(mark + 16);
+      size_t olen = 0;
+      int ret = mbedtls_cipher_finish(
+          &cbc_ctx_, reinterpret_cast<unsigned char*>(out.data() + mark),
+          &olen);
+      out.resize(ret == 0 ? mark + olen : mark);
+      return ret == 0;
+    }
+    // 解密时剩下的必须正好是 tag，否则密文被截断
+    if (!gcm_started_ ||
+        (!encrypt_ && pending_.size() != AESGCMCrypt::kTagSize)) {
+      return false;
+    }
+    gcm_started_ = false;
+    unsigned char tag[AESGCMCrypt::kTagSize];
+    size_t mark = out.size();
+    out.resize(mark + 15);  // gcm_finish 最多输出 15 字节
+    size_t olen = 0;
+    int ret = mbedtls_gcm_finish(
+        &gcm_ctx_, reinterpret_cast<unsigned char*>(out.data() + mark), 15,
+        &olen, tag, sizeof(tag));
+    out.resize(mark + olen);
+    if (ret != 0) {
+      return false;
+    }
+    if (encrypt_) {
+      out.append(reinterpret_cast<const char*>(tag), sizeof(tag));
+      return true;
+    }
+    // 常量时间比较，避免通过耗时猜测 tag
+    unsigned char diff = 0;
+    for (size_t i = 0; i < sizeof(tag); ++i) {
+      diff |= tag[i] ^ static_cast<unsigned char>(pending_[i]);
+    }
+    pending_.clear();
+    return diff == 0;
+  }
+
+ private:
+  bool CbcUpdate_(const unsigned char* input, size_t input_size,
+                  std::string& out) {
+    // mbedtls 要求输出缓冲区比输入多一个块
+    size_t mark = out.size();
+    out.resize(mark + input_size + 16);
+    size_t olen = 0;
+    int ret = mbedtls_cipher_update(
+        &cbc_ctx_, input, input_size,
+        reinterpret_cast<unsigned char*>(out.data() + mark), &olen);
+    out.resize(ret == 0 ? mark + olen : mark);
+    return ret == 0;
+  }
+
+  bool GcmUpdate_(const unsigned char* input, size_t input_size,
+                  std::string& out) {
+    // 输入不是 16 字节的整数倍时，mbedtls 最多多输出 15 字节
+    size_t mark = out.size();
+    out.resize(mark + input_size + 15);
+    size_t olen = 0;
+    int ret = mbedtls_gcm_update(
+        &gcm_ctx_, input, input_size,
+        reinterpret_cast<unsigned char*>(out.data() + mark), input_size + 15,
+        &olen);
+    out.resize(ret == 0 ? mark + olen : mark);
+    return ret == 0;
+  }
+
+ private:
+  CipherMode mode_;
+  bool encrypt_;
+  bool ready_ = false;        // 密钥（和随机数生成器）是否初始化成功
+  bool started_ = false;      // Begin 之后、Finish 之前
+  bool gcm_started_ = false;  // 已经用 nonce 开始了 GCM 运算
+  bool has_drbg_ = false;
+
+  mbedtls_cipher_context_t cbc_ctx_;
+  mbedtls_gcm_context gcm_ctx_;
+  mbedtls_entropy_context entropy_;
+  mbedtls_ctr_drbg_context drbg_;
+  std::string pending_;  // GCM 解密时还没处理的 nonce 和可能是 tag 的末尾数据
+};
+
+CipherStream::CipherStream(CipherMode mode, const std::string& key,
+                           CipherDirection direction)
+    : impl_(std::make_unique<Impl>(mode, key, direction)) {}
+
+CipherStream::~CipherStream() = default;
+
+bool CipherStream::Begin(std::string& out) { return impl_->Begin(out); }
+
+bool CipherStream::Update(const void* input, size_t input_size,
+                          std::string& out) {
+  return impl_->Update(reinterpret_cast<const unsigned char*>(input),
+                       input_size, out);
+}
+
+bool CipherStream::Finish(std::string& out) { return impl_->Finish(out); }
+
+std::unique_ptr<Crypt> CreateCrypt(CipherMode mode, const std::string& key) {
+  switch (mode) {
+    case CipherMode::kAesCbc:
+      return std::make_unique<AESCrypt>(key);
+    case CipherMode::kAesGcm:
+      return std::make_unique<AESGCMCrypt>(key);
+    default:
+      return nullptr;
+  }
+}
+
 }  // namespace buried
\ No newline at end of file
@@ -1,9 +1,19 @@
 #pragma once
+#include <stdint.h>
+
+#include <cstddef>
 #include <memory>
+#include <span>
 #include <string>
 
 namespace buried {
 
+// 加密算法，数值会随密文一起存入数据库，不能修改
+enum class CipherMode : int32_t {
+  kAesCbc = 0,  // AES-256-CBC + PKCS7，固定全 0 IV，旧数据使用
+  kAesGcm = 1,  // AES-256-GCM，每条消息随机 nonce，带完整性校验
+};
+
 // 加解密算法基类，定义通用接口
 class Crypt {
  public:
@@ -20,6 +30,24 @@ class Crypt {
 
   // 解密任意数据（纯虚函数，需子类实现）
   virtual std::string Decrypt(const void* input, size_t input_size) = 0;
+
+  // EncryptInto 需要的输出缓冲区大小
+  virtual size_t EncryptedSize(size_t input_size) const = 0;
+
+  // DecryptInto 需要的输出缓冲区大小
+  virtual size_t DecryptedSize(size_t input_size) const = 0;
+
+  // 加密到调用方提供的缓冲区，不分配内存。
+  // output 小于 EncryptedSize 或加密失败时返回 false，成功时 written 为实际长度
+  virtual bool EncryptInto(std::span<const std::byte> input,
+                           std::span<std::byte> output, size_t& written) = 0;
+
+  // 解密到调用方提供的缓冲区，不分配内存，规则同 EncryptInto
+  virtual bool DecryptInto(std::span<const std::byte> input,
+                           std::span<std::byte> output, size_t& written) = 0;
+
+  // 密钥是否设置成功，失败时加解密都返回失败
+  virtual bool Ready() const = 0;
 };
 
 // 前置声明，AES 加解密实现类（具体实现见 .cc 文件）
@@ -56,9 +84,101 @@ class AESCrypt : public Crypt {
   // 解密任意数据，重载基类接口
   std::string Decrypt(const void* input, size_t input_size) override;
 
+  // PKCS7 填充最多 16 字节，mbedtls 还要求输出比输入至少多一个块
+  size_t EncryptedSize(size_t input_size) const override;
+
+  size_t DecryptedSize(size_t input_size) const override;
+
+  bool EncryptInto(std::span<const std::byte> input,
+                   std::span<std::byte> output, size_t& written) override;
+
+  bool DecryptInto(std::span<const std::byte> input,
+                   std::span<std::byte> output, size_t& written) override;
+
+  bool Ready() const override;
+
  private:
   // 持有 AES 实现类的智能指针
   std::unique_ptr<AESImpl> impl_;
 };
 
+// 前置声明，AES-GCM 加解密实现类
+class AESGCMImpl;
+
+// 非线程安全的 AES-256-GCM 加解密类，密文格式为 nonce(12) + 密文 + tag(16)。
+// 没有填充，解密时校验 tag，数据被篡改时返回空字符串。
+// mbedtls 开启 AESNI 时自动使用 AES-NI 和 PCLMULQDQ 指令
+class AESGCMCrypt : public Crypt {
+ public:
+  static constexpr size_t kNonceSize = 12;
+  static constexpr size_t kTagSize = 16;
+
+  // key 为 32 字节密钥，可以由 AESCrypt::GetKey 生成
+  explicit AESGCMCrypt(const std::string& key);
+
+  ~AESGCMCrypt();
+
+  AESGCMCrypt(const AESGCMCrypt& other) = delete;
+  AESGCMCrypt& operator=(const AESGCMCrypt& other) = delete;
+
+  std::string Encrypt(const std::string& input) override;
+
+  std::string Decrypt(const std::string& input) override;
+
+  std::string Encrypt(const void* input, size_t input_size) override;
+
+  std::string Decrypt(const void* input, size_t input_size) override;
+
+  size_t EncryptedSize(size_t input_size) const override;
+
+  size_t DecryptedSize(size_t input_size) const override;
+
+  bool EncryptInto(std::span<const std::byte> input,
+                   std::span<std::byte> output, size_t& written) override;
+
+  bool DecryptInto(std::span<const std::byte> input,
+                   std::span<std::byte> output, size_t& written) override;
+
+  bool Ready() const override;
+
+ private:
+  std::unique_ptr<AESGCMImpl> impl_;
+};
+
+// 流式加解密的方向
+enum class CipherDirection { kEncrypt, kDecrypt };
+
+// 流式加解密器：Begin 之后分段 Update，最后 Finish，每步的输出追加到 out。
+// 输出格式与同一算法的 Encrypt 相同，解密可以接受任意切分的密文。
+// 只需要缓存不满一块的数据（GCM 解密还要缓存末尾的 tag），内存占用与总长度无关。
+// GCM 解密在 Finish 校验 tag 之前输出的明文未经认证，Finish 失败时必须全部丢弃。
+// 非线程安全，Begin 可以重复调用以开始新的一段数据
+class CipherStream {
+ public:
+  // key 为 32 字节密钥，mode 未知时所有操作都返回 false
+  CipherStream(CipherMode mode, const std::string& key,
+               CipherDirection direction);
+
+  ~CipherStream();
+
+  CipherStream(const CipherStream&) = delete;
+  CipherStream& operator=(const CipherStream&) = delete;
+
+  // 开始一段新的数据，GCM 加密时输出 nonce
+  bool Begin(std::string& out);
+
+  // 处理一段输入
+  bool Update(const void* input, size_t input_size, std::string& out);
+
+  // 结束当前数据，输出剩余的块，GCM 加密时输出 tag、解密时校验 tag
+  bool Finish(std::string& out);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+// 按算法创建加解密器，未知算法返回 nullptr
+std::unique_ptr<Crypt> CreateCrypt(CipherMode mode, const std::string& key);
+
 }  // namespace buried
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "crypt/crypt_pool.h"
+
+#include <atomic>
+#include <unordered_map>
+
+namespace buried {
+
+namespace {
+
+std::atomic<uint64_t> g_next_pool_id{1};
+
+// 线程缓存的一个条目，pool 过期后 crypt 已随对象池销毁
+struct LocalEntry {
+  std::weak_ptr<bool> pool;
+  Crypt* crypt;
+};
+
+}  // namespace
+
+CryptPool::Lease::~Lease() {
+  if (crypt_) {
+    pool_->Release_(std::move(crypt_));
+  }
+}
+
+CryptPool::CryptPool(Factory factory)
+    : id_(g_next_pool_id++), factory_(std::move(factory)) {}
+
+CryptPool::Lease CryptPool::Acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_.empty()) {
+      std::unique_ptr<Crypt> crypt = std::move(idle_.back());
+      idle_.pop_back();
+      return Lease(this, std::move(crypt));
+    }
+  }
+  return Lease(this, factory_());
+}
+
+Crypt& CryptPool::Local() {
+  thread_local std::unordered_map<uint64_t, LocalEntry> cache;
+  auto iter = cache.find(id_);
+  // 密钥派生失败时创建的实例不可用，下次使用时重新创建
+  if (iter != cache.end() && iter->second.crypt->Ready()) {
+    return *iter->second.crypt;
+  }
+  Crypt* stale = iter != cache.end() ? iter->second.crypt : nullptr;
+  // 只在新建时清理已销毁对象池的条目，缓存不会超过存活的对象池数
+  std::erase_if(cache, [](const auto& entry) {
+    return entry.second.pool.expired();
+  });
+  std::unique_ptr<Crypt> created = factory_();
+  Crypt* crypt = created.get();
+  cache[id_] = LocalEntry{alive_, crypt};
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::erase_if(locals_, [stale](const std::unique_ptr<Crypt>& local) {
+    return local.get() == stale;
+  });
+  locals_.push_back(std::move(created));
+  return *crypt;
+}
+
+// 不可用的实例不归还，下次借出时重新创建
+void CryptPool::Release_(std::unique_ptr<Crypt> crypt) {
+  if (!crypt->Ready()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_.push_back(std::move(crypt));
+}
+
+CryptPools::CryptPools(std::shared_ptr<KeyProvider> keys)
+    : keys_(std::move(keys)) {}
+
+CryptPool* CryptPools::Get(int32_t cipher, int32_t key_id) {
+  if (cipher != static_cast<int32_t>(CipherMode::kAesCbc) &&
+      cipher != static_cast<int32_t>(CipherMode::kAesGcm)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& pool = pools_[{cipher, key_id}];
+  if (!pool) {
+    pool = std::make_unique<CryptPool>([keys = keys_, cipher, key_id]() {
+      return CreateCrypt(static_cast<CipherMode>(cipher),
+                         keys->GetKey(key_id));
+    });
+  }
+  return pool.get();
+}
+
+}  // namespace buried
\ No newline at end of file
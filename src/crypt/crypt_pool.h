@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "crypt/crypt.h"
+#include "crypt/key_provider.h"
+
+namespace buried {
+
+// 加解密器对象池。AESCrypt 非线程安全，多个线程并行加解密时各自借出一个实例，
+// 用完自动归还，避免每次都重新创建上下文
+class CryptPool {
+ public:
+  using Factory = std::function<std::unique_ptr<Crypt>()>;
+
+  // 借出的加解密器，析构时归还给对象池
+  class Lease {
+   public:
+    Lease(CryptPool* pool, std::unique_ptr<Crypt> crypt)
+        : pool_(pool), crypt_(std::move(crypt)) {}
+
+    ~Lease();
+
+    Lease(Lease&& other) = default;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    Crypt* operator->() const { return crypt_.get(); }
+    Crypt& operator*() const { return *crypt_; }
+
+   private:
+    CryptPool* pool_;
+    std::unique_ptr<Crypt> crypt_;
+  };
+
+ public:
+  explicit CryptPool(Factory factory);
+
+  CryptPool(const CryptPool&) = delete;
+  CryptPool& operator=(const CryptPool&) = delete;
+
+  // 借出一个加解密器，没有空闲实例时新建
+  Lease Acquire();
+
+  // 当前线程专用的加解密器，只在线程第一次使用时加锁创建，之后不加锁。
+  // 实例归对象池所有，在对象池销毁前有效，不能跨线程使用
+  Crypt& Local();
+
+ private:
+  void Release_(std::unique_ptr<Crypt> crypt);
+
+ private:
+  // 对象池的唯一编号，线程缓存按编号查找，不会因为地址复用取到已销毁的实例
+  const uint64_t id_;
+  // 对象池销毁后过期，线程缓存据此清理已销毁对象池的条目
+  const std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+  Factory factory_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Crypt>> idle_;
+  std::vector<std::unique_ptr<Crypt>> locals_;
+};
+
+// 每种加密算法和密钥 id 的组合一个对象池，第一次使用时创建。
+// 新数据用指定的算法和密钥加密，已存储的数据按各自记录的算法和密钥 id 解密。
+// 线程安全，返回的对象池在 CryptPools 销毁前有效
+class CryptPools {
+ public:
+  explicit CryptPools(std::shared_ptr<KeyProvider> keys);
+
+  CryptPools(const CryptPools&) = delete;
+  CryptPools& operator=(const CryptPools&) = delete;
+
+  // 未知算法返回 nullptr。密钥在第一次创建加解密器时才向 KeyProvider 获取
+  CryptPool* Get(int32_t cipher, int32_t key_id);
+
+  CryptPool* Get(CipherMode mode, int32_t key_id) {
+    return Get(static_cast<int32_t>(mode), key_id);
+  }
+
+ private:
+  std::shared_ptr<KeyProvider> keys_;
+
+  std::mutex mutex_;
+  std::map<std::pair<int32_t, int32_t>, std::unique_ptr<CryptPool>> pools_;
+};
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "crypt/key_provider.h"
+
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+#include "crypt/crypt.h"
+#include "third_party/mbedtls/include/mbedtls/platform_util.h"
+
+namespace buried {
+
+KeyProvider::Derive KeyProvider::Pbkdf2(std::string salt,
+                                        std::string password) {
+  return [salt = std::move(salt),
+          password = std::move(password)](int32_t key_id) {
+    if (key_id == kLegacyKeyId) {
+      return AESCrypt::GetKey(salt, password);
+    }
+    return AESCrypt::GetKey(salt + "#" + std::to_string(key_id), password);
+  };
+}
+
+KeyProvider::KeyProvider(Derive derive) : derive_(std::move(derive)) {}
+
+// 等待中的派生由调用方线程完成，析构前调用方应已退出
+KeyProvider::~KeyProvider() {
+  for (auto& [key_id, key] : keys_) {
+    if (key.valid() &&
+        key.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      std::string& value = const_cast<std::string&>(key.get());
+      mbedtls_platform_zeroize(value.data(), value.size());
+    }
+  }
+}
+
+// 等待的是另一个正在派生的线程，而不是排队中的任务，线程池再小也不会死锁
+std::string KeyProvider::GetKey(int32_t key_id) {
+  std::promise<std::string> promise;
+  std::shared_future<std::string> key;
+  bool derive = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = keys_.find(key_id);
+    if (iter == keys_.end()) {
+      iter = keys_.emplace(key_id, promise.get_future().share()).first;
+      derive = true;
+    }
+    key = iter->second;
+  }
+  if (derive) {
+    std::string value;
+    try {
+      value = derive_(key_id);
+    } catch (const std::exception&) {
+      value.clear();
+    }
+    if (value.empty()) {
+      // 先移出缓存再通知等待的线程，之后的调用重新派生
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        keys_.erase(key_id);
+      }
+      promise.set_exception(
+          std::make_exception_ptr(std::runtime_error("derive key failed")));
+    } else {
+      promise.set_value(std::move(value));
+    }
+  }
+  try {
+    return key.get();
+  } catch (const std::runtime_error&) {
+    return std::string();
+  }
+}
+
+bool KeyProvider::IsReady(int32_t key_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = keys_.find(key_id);
+  return iter != keys_.end() &&
+         iter->second.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+}
+
+}  // namespace buried
\ No newline at end of file
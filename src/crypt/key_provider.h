@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace buried {
+
+// 按 id 提供 AES 密钥。派生（PBKDF2）只做一次，结果缓存在内存中，
+// 析构时清零。密钥轮换时递增 id，旧数据仍按各自记录的 id 取得旧密钥。
+// 线程安全：同一个 id 只由第一个请求的线程派生，其他线程等待它的结果
+class KeyProvider {
+ public:
+  using Derive = std::function<std::string(int32_t key_id)>;
+
+  // 旧版本数据使用的密钥 id
+  static constexpr int32_t kLegacyKeyId = 0;
+
+  // 基于 AESCrypt::GetKey 的派生方式：kLegacyKeyId 与旧版本的密钥相同，
+  // 其他 id 把 id 拼接到盐上
+  static Derive Pbkdf2(std::string salt, std::string password);
+
+  explicit KeyProvider(Derive derive);
+
+  ~KeyProvider();
+
+  KeyProvider(const KeyProvider&) = delete;
+  KeyProvider& operator=(const KeyProvider&) = delete;
+
+  // 取得密钥，还没有派生时在当前线程上派生。派生失败返回空字符串，
+  // 失败的结果不缓存，下一次调用重新派生
+  std::string GetKey(int32_t key_id);
+
+  // 是否已经派生完成，不会阻塞
+  bool IsReady(int32_t key_id);
+
+ private:
+  Derive derive_;
+
+  std::mutex mutex_;
+  std::map<int32_t, std::shared_future<std::string>> keys_;
+};
+
+}  // namespace buried
\ No newline at end of file
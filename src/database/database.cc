@@ -1,18 +1,113 @@
 #include "database/database.h"
 
+#include <algorithm>
+#include <mutex>
+#include <string>
+
 #include "third_party/sqlite/sqlite_orm.h"
 
 using namespace sqlite_orm;
 namespace buried {
 
+// 单条 IN (...) 语句最多携带的 id 数，低于 SQLite 默认的绑定参数上限
+static constexpr size_t kMaxIdsPerStatement = 999;
+
+// 数据库结构版本，记录在 PRAGMA user_version 中，结构变化时递增
+// 1: 增加 (priority DESC, id) 复合索引
+// 2: 增加 state 列，索引改为 (state, priority DESC, id)
+// 3: 增加 buried_header 表和 header_id 列，公共字段不再逐条存储
+// 4: 增加 buried_string 字典表
+// 5: 各表增加 cipher 列，记录内容的加密算法
+// 6: 各表增加 key_id 列，记录内容的密钥 id
+static constexpr int kSchemaVersion = 6;
+
 inline auto InitStorage(const std::string& path) {
   return make_storage(
-      path, make_table("buried_data",
+      path,
+      make_index("buried_data_state_priority_id_idx",
+                 indexed_column(&BuriedDb::Data::state),
+                 indexed_column(&BuriedDb::Data::priority).desc(),
+                 indexed_column(&BuriedDb::Data::id)),
+      make_table("buried_data",
                        make_column("id", &BuriedDb::Data::id,
                                    primary_key().autoincrement()),
                        make_column("priority", &BuriedDb::Data::priority),
                        make_column("timestamp", &BuriedDb::Data::timestamp),
-                       make_column("content", &BuriedDb::Data::content)));
+                       make_column("content", &BuriedDb::Data::content),
+                       make_column("state", &BuriedDb::Data::state,
+                                   default_value(0)),
+                       make_column("header_id", &BuriedDb::Data::header_id,
+                                   default_value(0)),
+                       make_column("cipher", &BuriedDb::Data::cipher,
+                                   default_value(0)),
+                       make_column("key_id", &BuriedDb::Data::key_id,
+                                   default_value(0))),
+      make_table("buried_header",
+                 make_column("id", &BuriedDb::Header::id,
+                             primary_key().autoincrement()),
+                 make_column("content", &BuriedDb::Header::content),
+                 make_column("cipher", &BuriedDb::Header::cipher,
+                             default_value(0)),
+                 make_column("key_id", &BuriedDb::Header::key_id,
+                             default_value(0))),
+      make_table("buried_string",
+                 make_column("id", &BuriedDb::DictString::id, primary_key()),
+                 make_column("content", &BuriedDb::DictString::content),
+                 make_column("cipher", &BuriedDb::DictString::cipher,
+                             default_value(0)),
+                 make_column("key_id", &BuriedDb::DictString::key_id,
+                             default_value(0))));
+}
+
+// 把一组数据的 id 转换成尽量少的条件语句交给 apply 执行：
+// id 连续时整批是一个 BETWEEN 区间，否则按 IN (...) 分段
+template <typename F>
+static void ApplyToIds(const std::vector<BuriedDb::Data>& datas, F&& apply) {
+  if (datas.empty()) {
+    return;
+  }
+  std::vector<int32_t> ids;
+  ids.reserve(datas.size());
+  for (const auto& data : datas) {
+    ids.push_back(data.id);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  if (static_cast<size_t>(ids.back() - ids.front()) + 1 == ids.size()) {
+    apply(where(between(&BuriedDb::Data::id, ids.front(), ids.back())));
+    return;
+  }
+  for (size_t i = 0; i < ids.size(); i += kMaxIdsPerStatement) {
+    size_t end = std::min(ids.size(), i + kMaxIdsPerStatement);
+    apply(where(in(&BuriedDb::Data::id,
+                   std::vector<int32_t>(ids.begin() + i, ids.begin() + end))));
+  }
+}
+
+// 按存储档位生成每个连接打开时执行的 PRAGMA 语句
+static std::string ProfilePragmas(BuriedDb::StorageProfile profile) {
+  // WAL 模式下读事务不会阻塞写事务，写事务也不会阻塞读事务
+  std::string sql = "PRAGMA journal_mode=WAL;PRAGMA busy_timeout=5000;";
+  switch (profile) {
+    case BuriedDb::StorageProfile::kDurable:
+      sql +=
+          "PRAGMA synchronous=FULL;PRAGMA cache_size=-2000;"
+          "PRAGMA mmap_size=0;PRAGMA temp_store=DEFAULT;";
+      break;
+    case BuriedDb::StorageProfile::kThroughput:
+      sql +=
+          "PRAGMA synchronous=OFF;PRAGMA cache_size=-32768;"
+          "PRAGMA mmap_size=268435456;PRAGMA temp_store=MEMORY;";
+      break;
+    case BuriedDb::StorageProfile::kBalanced:
+    default:
+      sql +=
+          "PRAGMA synchronous=NORMAL;PRAGMA cache_size=-8192;"
+          "PRAGMA mmap_size=67108864;PRAGMA temp_store=MEMORY;";
+      break;
+  }
+  return sql;
 }
 
 class BuriedDbImpl {
@@ -20,9 +115,26 @@ class BuriedDbImpl {
   using DBStorage = decltype(InitStorage(""));
 
  public:
-  BuriedDbImpl(std::string db_path) : db_path_(db_path) {
+  BuriedDbImpl(std::string db_path, BuriedDb::StorageProfile profile)
+      : db_path_(db_path) {
+    std::string pragmas = ProfilePragmas(profile);
+
+    // 写连接，负责建表、插入和删除
     storage_ = std::make_unique<DBStorage>(InitStorage(db_path_));
-    storage_->sync_schema();
+    storage_->on_open = [pragmas](sqlite3* db) {
+      sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr);
+    };
+    // 保持连接常开，避免每次操作都重新打开数据库，PRAGMA 也只需设置一次
+    storage_->open_forever();
+    MigrateSchema_();
+
+    // 只读连接，负责上报查询
+    reader_ = std::make_unique<DBStorage>(InitStorage(db_path_));
+    reader_->on_open = [pragmas](sqlite3* db) {
+      sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr);
+      sqlite3_exec(db, "PRAGMA query_only=1;", nullptr, nullptr, nullptr);
+    };
+    reader_->open_forever();
   }
 
   ~BuriedDbImpl() {}
@@ -33,6 +145,20 @@ class BuriedDbImpl {
     guard.commit();
   }
 
+  void InsertDatas(const std::vector<BuriedDb::Data>& datas) {
+    if (datas.empty()) {
+      return;
+    }
+    auto guard = storage_->transaction_guard();
+    // 只编译一次 INSERT 语句，每一行重新绑定参数后执行
+    auto statement = storage_->prepare(insert(std::cref(datas.front())));
+    for (const auto& data : datas) {
+      statement.expression.object = std::cref(data);
+      storage_->execute(statement);
+    }
+    guard.commit();
+  }
+
   void DeleteData(const BuriedDb::Data& data) {
     auto guard = storage_->transaction_guard();
     storage_->remove_all<BuriedDb::Data>(
@@ -41,33 +167,208 @@ class BuriedDbImpl {
   }
 
   void DeleteDatas(const std::vector<BuriedDb::Data>& datas) {
+    if (datas.empty()) {
+      return;
+    }
     auto guard = storage_->transaction_guard();
-    for (const auto& data : datas) {
+    ApplyToIds(datas, [this](auto condition) {
+      storage_->remove_all<BuriedDb::Data>(condition);
+    });
+    guard.commit();
+  }
+
+  void UpdateState(const std::vector<BuriedDb::Data>& datas, int32_t state) {
+    if (datas.empty()) {
+      return;
+    }
+    auto guard = storage_->transaction_guard();
+    ApplyToIds(datas, [this, state](auto condition) {
+      storage_->update_all(set(c(&BuriedDb::Data::state) = state), condition);
+    });
+    guard.commit();
+  }
+
+  void ResetInFlight() {
+    storage_->update_all(
+        set(c(&BuriedDb::Data::state) = BuriedDb::kPending),
+        where(c(&BuriedDb::Data::state) == BuriedDb::kInFlight));
+  }
+
+  int32_t CountUnreadable() {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    return reader_->count<BuriedDb::Data>(
+        where(c(&BuriedDb::Data::state) == BuriedDb::kUnreadable));
+  }
+
+  int32_t PurgeUnreadable(uint64_t expire_before, int32_t max_rows) {
+    auto guard = storage_->transaction_guard();
+    storage_->remove_all<BuriedDb::Data>(
+        where(c(&BuriedDb::Data::state) == BuriedDb::kUnreadable &&
+              c(&BuriedDb::Data::timestamp) < expire_before));
+    int32_t purged = storage_->changes();
+    // 第 max_rows + 1 新的一行以及更旧的行都删除
+    auto ids = storage_->select(
+        &BuriedDb::Data::id,
+        where(c(&BuriedDb::Data::state) == BuriedDb::kUnreadable),
+        order_by(&BuriedDb::Data::id).desc(), limit(1, offset(max_rows)));
+    if (!ids.empty()) {
       storage_->remove_all<BuriedDb::Data>(
-          where(c(&BuriedDb::Data::id) == data.id));
+          where(c(&BuriedDb::Data::state) == BuriedDb::kUnreadable &&
+                c(&BuriedDb::Data::id) <= ids.front()));
+      purged += storage_->changes();
     }
     guard.commit();
+    return purged;
+  }
+
+  int32_t InsertHeader(const std::vector<char>& content, int32_t cipher,
+                       int32_t key_id) {
+    return storage_->insert(BuriedDb::Header{-1, content, cipher, key_id});
+  }
+
+  bool QueryHeader(int32_t id, BuriedDb::Header& header) {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    auto ptr = reader_->get_pointer<BuriedDb::Header>(id);
+    if (!ptr) {
+      return false;
+    }
+    header = std::move(*ptr);
+    return true;
+  }
+
+  void DeleteUnusedHeaders(int32_t keep_id) {
+    storage_->remove_all<BuriedDb::Header>(
+        where(c(&BuriedDb::Header::id) != keep_id &&
+              not_in(&BuriedDb::Header::id,
+                     select(&BuriedDb::Data::header_id))));
+  }
+
+  void InsertStrings(const std::vector<BuriedDb::DictString>& strings) {
+    if (strings.empty()) {
+      return;
+    }
+    auto guard = storage_->transaction_guard();
+    for (const auto& string : strings) {
+      storage_->replace(string);
+    }
+    guard.commit();
+  }
+
+  std::vector<BuriedDb::DictString> QueryStrings() {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    return reader_->get_all<BuriedDb::DictString>(
+        order_by(&BuriedDb::DictString::id));
   }
 
   std::vector<BuriedDb::Data> QueryData(int32_t limit_size) {
-    auto limited = storage_->get_all<BuriedDb::Data>(
-        order_by(&BuriedDb::Data::priority).desc(), limit(limit_size));
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    auto limited = reader_->get_all<BuriedDb::Data>(
+        where(c(&BuriedDb::Data::state) == BuriedDb::kPending),
+        multi_order_by(order_by(&BuriedDb::Data::priority).desc(),
+                       order_by(&BuriedDb::Data::id)),
+        limit(limit_size));
     return limited;
   }
 
+  std::vector<BuriedDb::Summary> QuerySummaries(int32_t limit_size) {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    auto rows = reader_->select(
+        columns(&BuriedDb::Data::id, &BuriedDb::Data::priority,
+                &BuriedDb::Data::header_id, length(&BuriedDb::Data::content)),
+        where(c(&BuriedDb::Data::state) == BuriedDb::kPending),
+        multi_order_by(order_by(&BuriedDb::Data::priority).desc(),
+                       order_by(&BuriedDb::Data::id)),
+        limit(limit_size));
+    std::vector<BuriedDb::Summary> summaries;
+    summaries.reserve(rows.size());
+    for (const auto& row : rows) {
+      summaries.push_back(BuriedDb::Summary{
+          std::get<0>(row), std::get<1>(row), std::get<2>(row),
+          static_cast<size_t>(std::get<3>(row))});
+    }
+    return summaries;
+  }
+
+  std::vector<BuriedDb::Data> QueryDataByIds(const std::vector<int32_t>& ids) {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    std::vector<BuriedDb::Data> datas;
+    for (size_t i = 0; i < ids.size(); i += kMaxIdsPerStatement) {
+      size_t end = std::min(ids.size(), i + kMaxIdsPerStatement);
+      auto part = reader_->get_all<BuriedDb::Data>(where(
+          in(&BuriedDb::Data::id,
+             std::vector<int32_t>(ids.begin() + i, ids.begin() + end))));
+      datas.insert(datas.end(), std::make_move_iterator(part.begin()),
+                   std::make_move_iterator(part.end()));
+    }
+    std::sort(datas.begin(), datas.end(),
+              [](const BuriedDb::Data& lhs, const BuriedDb::Data& rhs) {
+                return lhs.priority != rhs.priority
+                           ? lhs.priority > rhs.priority
+                           : lhs.id < rhs.id;
+              });
+    return datas;
+  }
+
+  // 拆成两次索引区间扫描：先取同优先级中 id 更大的，不够再取更低优先级的。
+  // 两次都能沿着 (state, priority DESC, id) 索引顺序读取，无需排序
+  std::vector<BuriedDb::Data> QueryDataAfter(const BuriedDb::Cursor& cursor,
+                                             int32_t limit_size) {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    auto datas = reader_->get_all<BuriedDb::Data>(
+        where(c(&BuriedDb::Data::state) == BuriedDb::kPending &&
+              c(&BuriedDb::Data::priority) == cursor.priority &&
+              c(&BuriedDb::Data::id) > cursor.id),
+        order_by(&BuriedDb::Data::id), limit(limit_size));
+    int32_t rest = limit_size - static_cast<int32_t>(datas.size());
+    if (rest <= 0) {
+      return datas;
+    }
+    auto lower = reader_->get_all<BuriedDb::Data>(
+        where(c(&BuriedDb::Data::state) == BuriedDb::kPending &&
+              c(&BuriedDb::Data::priority) < cursor.priority),
+        multi_order_by(order_by(&BuriedDb::Data::priority).desc(),
+                       order_by(&BuriedDb::Data::id)),
+        limit(rest));
+    datas.insert(datas.end(), std::make_move_iterator(lower.begin()),
+                 std::make_move_iterator(lower.end()));
+    return datas;
+  }
+
+ private:
+  // 只有版本落后时才做结构同步（建表、建索引），之后更新版本号
+  void MigrateSchema_() {
+    int version = storage_->pragma.user_version();
+    if (version >= kSchemaVersion) {
+      return;
+    }
+    if (version == 1) {
+      storage_->drop_index("buried_data_priority_id_idx");
+    }
+    storage_->sync_schema(true);
+    storage_->pragma.user_version(kSchemaVersion);
+  }
+
  private:
   std::string db_path_;
 
   std::unique_ptr<DBStorage> storage_;
+  // sqlite_orm 的常开连接不能在多个线程上同时使用，上报 strand 和
+  // 计算线程上的请求体都通过这个锁串行使用只读连接
+  std::mutex reader_mutex_;
+  std::unique_ptr<DBStorage> reader_;
 };
 
-BuriedDb::BuriedDb(std::string db_path)
-    : impl_{std::make_unique<BuriedDbImpl>(std::move(db_path))} {}
+BuriedDb::BuriedDb(std::string db_path, StorageProfile profile)
+    : impl_{std::make_unique<BuriedDbImpl>(std::move(db_path), profile)} {}
 
 BuriedDb::~BuriedDb() {}
 
 void BuriedDb::InsertData(const Data& data) { impl_->InsertData(data); }
 
+void BuriedDb::InsertDatas(const std::vector<Data>& datas) {
+  impl_->InsertDatas(datas);
+}
+
 void BuriedDb::DeleteData(const Data& data) { impl_->DeleteData(data); }
 
 void BuriedDb::DeleteDatas(const std::vector<Data>& datas) {
@@ -78,4 +379,59 @@ std::vector<BuriedDb::Data> BuriedDb::QueryData(int32_t limit) {
   return impl_->QueryData(limit);
 }
 
+std::vector<BuriedDb::Data> BuriedDb::QueryDataAfter(const Cursor& cursor,
+                                                     int32_t limit) {
+  return impl_->QueryDataAfter(cursor, limit);
+}
+
+std::vector<BuriedDb::Summary> BuriedDb::QuerySummaries(int32_t limit) {
+  return impl_->QuerySummaries(limit);
+}
+
+std::vector<BuriedDb::Data> BuriedDb::QueryDataByIds(
+    const std::vector<int32_t>& ids) {
+  return impl_->QueryDataByIds(ids);
+}
+
+void BuriedDb::MarkInFlight(const std::vector<Data>& datas) {
+  impl_->UpdateState(datas, kInFlight);
+}
+
+void BuriedDb::MarkPending(const std::vector<Data>& datas) {
+  impl_->UpdateState(datas, kPending);
+}
+
+void BuriedDb::MarkUnreadable(const std::vector<Data>& datas) {
+  impl_->UpdateState(datas, kUnreadable);
+}
+
+void BuriedDb::ResetInFlight() { impl_->ResetInFlight(); }
+
+int32_t BuriedDb::CountUnreadable() { return impl_->CountUnreadable(); }
+
+int32_t BuriedDb::PurgeUnreadable(uint64_t expire_before, int32_t max_rows) {
+  return impl_->PurgeUnreadable(expire_before, max_rows);
+}
+
+int32_t BuriedDb::InsertHeader(const std::vector<char>& content,
+                               int32_t cipher, int32_t key_id) {
+  return impl_->InsertHeader(content, cipher, key_id);
+}
+
+bool BuriedDb::QueryHeader(int32_t id, Header& header) {
+  return impl_->QueryHeader(id, header);
+}
+
+void BuriedDb::DeleteUnusedHeaders(int32_t keep_id) {
+  impl_->DeleteUnusedHeaders(keep_id);
+}
+
+void BuriedDb::InsertStrings(const std::vector<DictString>& strings) {
+  impl_->InsertStrings(strings);
+}
+
+std::vector<BuriedDb::DictString> BuriedDb::QueryStrings() {
+  return impl_->QueryStrings();
+}
+
 }  // namespace buried
\ No newline at end of file
@@ -11,26 +11,128 @@ namespace buried {
 class BuriedDbImpl;
 class BuriedDb {
  public:
+  // 存储配置档位，决定 SQLite 的日志模式、同步级别和缓存等参数。
+  // 三种档位都使用 WAL，上报读取和写入互不阻塞
+  enum class StorageProfile {
+    kDurable,     // synchronous=FULL，每次提交都落盘
+    kBalanced,    // synchronous=NORMAL，只在 checkpoint 时落盘
+    kThroughput,  // synchronous=OFF，更大的缓存和 mmap，掉电可能丢失最近数据
+  };
+
+  // 数据的上报状态
+  static constexpr int32_t kPending = 0;     // 等待上报
+  static constexpr int32_t kInFlight = 1;    // 已发出上报请求，等待确认
+  static constexpr int32_t kUnreadable = 2;  // 无法解密或解码，保留不再上报
+
+  // content 中已经包含全部公共字段的旧数据，header_id 为 0
+  static constexpr int32_t kNoHeader = 0;
+
   struct Data {
     int32_t id;
     int32_t priority;
     uint64_t timestamp;
     std::vector<char> content;
+    int32_t state = kPending;
+    int32_t header_id = kNoHeader;  // 所属的公共字段头，见 Header
+    int32_t cipher = 0;             // content 的加密算法，见 CipherMode
+    int32_t key_id = 0;             // content 的密钥 id，见 KeyProvider
+  };
+
+  // 一次生命周期内所有事件共享的公共字段，只存一份，事件通过 header_id 引用
+  struct Header {
+    int32_t id;
+    std::vector<char> content;
+    int32_t cipher = 0;
+    int32_t key_id = 0;
+  };
+
+  // 字符串字典的一个条目，事件内容通过 id 引用重复出现的字符串（标题等）。
+  // id 由调用方分配，content 与事件内容一样是加密后的字符串
+  struct DictString {
+    int32_t id;
+    std::vector<char> content;
+    int32_t cipher = 0;
+    int32_t key_id = 0;
+  };
+
+  // 一行数据的摘要，不包含内容，用于在不读取内容的情况下组织上报批次
+  struct Summary {
+    int32_t id;
+    int32_t priority;
+    int32_t header_id;
+    size_t size;  // content 的字节数
+  };
+
+  // 按 (priority DESC, id ASC) 顺序分页查询时的位置，记录上一页最后一行
+  struct Cursor {
+    int32_t priority;
+    int32_t id;
   };
 
  public:
-  BuriedDb(std::string db_path);
+  BuriedDb(std::string db_path,
+           StorageProfile profile = StorageProfile::kBalanced);
 
   ~BuriedDb();
 
   void InsertData(const Data& data);
 
+  // 在一个事务内批量插入，复用同一个预编译语句
+  void InsertDatas(const std::vector<Data>& datas);
+
   void DeleteData(const Data& data);
 
   void DeleteDatas(const std::vector<Data>& datas);
 
+  // 查询等待上报的数据，走独立的只读连接，可以与写入在不同线程上并发执行
   std::vector<Data> QueryData(int32_t limit);
 
+  // 键集分页：查询排在 cursor 之后的最多 limit 条等待上报的数据，
+  // 开销只与 limit 相关
+  std::vector<Data> QueryDataAfter(const Cursor& cursor, int32_t limit);
+
+  // 按 QueryData 的顺序查询等待上报数据的摘要，不读取内容
+  std::vector<Summary> QuerySummaries(int32_t limit);
+
+  // 按 id 查询数据（不限状态），结果按 (priority DESC, id ASC) 排序。
+  // 走只读连接，上报时由多个计算线程分页读取内容，查询之间互斥
+  std::vector<Data> QueryDataByIds(const std::vector<int32_t>& ids);
+
+  // 标记为上报中，之后的查询不会再返回这些数据
+  void MarkInFlight(const std::vector<Data>& datas);
+
+  // 上报失败时恢复为等待上报
+  void MarkPending(const std::vector<Data>& datas);
+
+  // 上报时无法解密或解码的数据保留在数据库中，之后的查询不会再返回
+  void MarkUnreadable(const std::vector<Data>& datas);
+
+  // 把所有上报中的数据恢复为等待上报，用于进程异常退出后的启动恢复
+  void ResetInFlight();
+
+  // 无法解密或解码的数据条数
+  int32_t CountUnreadable();
+
+  // 删除 timestamp 早于 expire_before 的无法读取的数据，
+  // 再按 id 只保留最新的 max_rows 条，返回删除的条数
+  int32_t PurgeUnreadable(uint64_t expire_before, int32_t max_rows);
+
+  // 写入一个公共字段头，返回它的 id
+  int32_t InsertHeader(const std::vector<char>& content, int32_t cipher = 0,
+                       int32_t key_id = 0);
+
+  // 查询公共字段头，不存在时返回 false
+  bool QueryHeader(int32_t id, Header& header);
+
+  // 删除除 keep_id 以外不再被任何数据引用的公共字段头
+  void DeleteUnusedHeaders(int32_t keep_id);
+
+  // 在一个事务内写入字典条目，id 已存在时覆盖
+  void InsertStrings(const std::vector<DictString>& strings);
+
+  // 查询全部字典条目
+  std::vector<DictString> QueryStrings();
+
  private:
   std::unique_ptr<BuriedDbImpl> impl_;
 };
@@ -1,14 +1,31 @@
 #include "report/buried_report.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <filesystem>
+#include <future>
+#include <map>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 
 #include "boost/asio/deadline_timer.hpp"
 #include "boost/asio/io_service.hpp"
+#include "boost/asio/post.hpp"
+#include "boost/asio/steady_timer.hpp"
 #include "context/context.h"
 #include "crypt/crypt.h"
+#include "crypt/crypt_pool.h"
+#include "crypt/key_provider.h"
 #include "database/database.h"
+#include "report/http_connection_pool.h"
+#include "report/event_builder.h"
 #include "report/http_report.h"
+#include "report/row_codec.h"
+#include "report/string_dictionary.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 
@@ -17,158 +34,824 @@ namespace buried {
 // 数据库文件名常量
 static const char kDbName[] = "buried.db";
 
+// 同时在计算线程上编码的批次上限，超过后暂停从环形队列取数
+static constexpr size_t kMaxEncodingChunks = 8;
+
+// 流式上报时每次从数据库读取的行数
+static constexpr size_t kRowsPerChunk = 64;
+
+// 上报批次的流式请求体：每次按 id 从数据库读取一页数据，解密后拼接成一段。
+// 新数据为 {"header": 公共字段, "events": [事件...]}，
+// 旧数据（content 自带公共字段）为 [事件...]。
+// 二进制行在这里转换成 JSON 对象，旧的 JSON 行原样拼接，都不再转义成 JSON 字符串。
+// 公共字段头无法读取时写为 null，无法解密或解码的行跳过并记录在 Unreadable() 中。
+// wire_ids 时新数据末尾附带 "strings" 字典。
+// 数据库、对象池和字典都共享持有，BuriedReportImpl 析构后仍在发送的批次可以安全读完
+class BatchBodySource : public HttpBodySource {
+ public:
+  BatchBodySource(std::shared_ptr<spdlog::logger> logger,
+                  std::shared_ptr<BuriedDb> db,
+                  std::shared_ptr<CryptPools> crypt_pools,
+                  std::shared_ptr<const StringDictionary> dictionary,
+                  std::vector<int32_t> ids, std::optional<std::string> header,
+                  bool enveloped, bool quote_events, bool wire_ids)
+      : logger_(std::move(logger)),
+        db_(std::move(db)),
+        crypt_pools_(std::move(crypt_pools)),
+        dictionary_(std::move(dictionary)),
+        ids_(std::move(ids)),
+        header_(std::move(header)),
+        enveloped_(enveloped),
+        quote_events_(quote_events),
+        wire_ids_(enveloped && wire_ids),
+        writer_(dictionary_.get(), wire_ids_) {}
+
+  bool Read(std::string& chunk) override {
+    if (next_ == 0) {
+      if (enveloped_) {
+        chunk += "{\"header\":";
+        if (header_) {
+          AppendJson_(chunk, *header_);
+        } else {
+          chunk += "null";
+        }
+        chunk += ",\"events\":";
+      }
+      chunk += '[';
+    }
+    size_t end = std::min(ids_.size(), next_ + kRowsPerChunk);
+    auto datas = db_->QueryDataByIds(
+        std::vector<int32_t>(ids_.begin() + next_, ids_.begin() + end));
+    next_ = end;
+
+    // 一页中的数据可能来自不同版本，按各自的算法和密钥取当前线程的解密器，
+    // 解密到复用的缓冲区。每次 Read 可能在不同的计算线程上执行，
+    // 解密器每次都按当前线程重新获取
+    for (const auto& data : datas) {
+      CryptPool* pool = Pool_(data.cipher, data.key_id);
+      Crypt* crypt = pool ? &pool->Local() : nullptr;
+      if (crypt == nullptr) {
+        SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl unknown cipher {}",
+                            data.cipher);
+        unreadable_.push_back(data.id);
+        continue;
+      }
+      plain_.resize(crypt->DecryptedSize(data.content.size()));
+      size_t written = 0;
+      if (!crypt->DecryptInto(std::as_bytes(std::span(data.content)),
+                              std::as_writable_bytes(std::span(plain_)),
+                              written) ||
+          written == 0) {
+        SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl decrypt data {} failed",
+                            data.id);
+        unreadable_.push_back(data.id);
+        continue;
+      }
+      std::string_view content(plain_.data(), written);
+      size_t mark = chunk.size();
+      if (!first_) {
+        chunk += ',';
+      }
+      if (!AppendEvent_(chunk, content, data.timestamp)) {
+        SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl decode data {} failed",
+                            data.id);
+        chunk.resize(mark);
+        unreadable_.push_back(data.id);
+        continue;
+      }
+      first_ = false;
+    }
+
+    if (next_ < ids_.size()) {
+      return true;
+    }
+    chunk += ']';
+    if (wire_ids_) {
+      chunk += ",\"strings\":";
+      writer_.AppendStrings(chunk);
+    }
+    if (enveloped_) {
+      chunk += '}';
+    }
+    return false;
+  }
+
+  void Rewind() override {
+    next_ = 0;
+    first_ = true;
+    writer_.Reset();
+    unreadable_.clear();
+  }
+
+  // 已读取的行中无法解密或解码、没有写入请求体的行 id，
+  // 上报完成后在上报 strand 上读取
+  const std::vector<int32_t>& Unreadable() const { return unreadable_; }
+
+ private:
+  // 转义时非法的 UTF-8 替换为 U+FFFD，不会在计算线程上抛出异常
+  void AppendJson_(std::string& chunk, const std::string& json) {
+    if (quote_events_) {
+      AppendJsonString(chunk, json);
+    } else {
+      chunk += json;
+    }
+  }
+
+  // 每种算法和密钥 id 只查找一次对象池，未知算法返回 nullptr。
+  // 只缓存对象池，不缓存属于某个线程的解密器
+  CryptPool* Pool_(int32_t cipher, int32_t key_id) {
+    auto pool_key = std::make_pair(cipher, key_id);
+    auto iter = pools_.find(pool_key);
+    if (iter == pools_.end()) {
+      iter = pools_.emplace(pool_key, crypt_pools_->Get(cipher, key_id)).first;
+    }
+    return iter->second;
+  }
+
+  bool AppendEvent_(std::string& chunk, std::string_view content,
+                    int64_t timestamp) {
+    if (!quote_events_) {
+      return writer_.Append(content, timestamp, chunk);
+    }
+    event_.clear();
+    if (!writer_.Append(content, timestamp, event_)) {
+      return false;
+    }
+    AppendJson_(chunk, event_);
+    return true;
+  }
+
+ private:
+  std::shared_ptr<spdlog::logger> logger_;
+  std::shared_ptr<BuriedDb> db_;
+  std::shared_ptr<CryptPools> crypt_pools_;
+  std::shared_ptr<const StringDictionary> dictionary_;
+  std::vector<int32_t> ids_;
+  std::optional<std::string> header_;
+  bool enveloped_;
+  bool quote_events_;
+  bool wire_ids_;
+  RowJsonWriter writer_;
+  std::string event_;   // quote_events_ 时转义前的单个事件
+  std::string plain_;   // 解密后的单行内容
+  std::map<std::pair<int32_t, int32_t>, CryptPool*> pools_;
+  std::vector<int32_t> unreadable_;
+
+  size_t next_ = 0;     // 下一页第一行在 ids_ 中的位置
+  bool first_ = true;   // 是否还没有写入任何事件
+};
+
+// 请求体整体加密。密钥在第一次 Begin 时获取，此时已经在计算线程上，
+// 还没有派生完成时也不会阻塞上报 strand
+class CipherBodyFilter : public HttpBodyFilter {
+ public:
+  CipherBodyFilter(std::shared_ptr<KeyProvider> keys, CipherMode mode,
+                   int32_t key_id)
+      : keys_(std::move(keys)), mode_(mode), key_id_(key_id) {}
+
+  bool Begin(std::string& out) override {
+    if (!stream_) {
+      stream_ = std::make_unique<CipherStream>(mode_, keys_->GetKey(key_id_),
+                                               CipherDirection::kEncrypt);
+    }
+    return stream_->Begin(out);
+  }
+
+  bool Update(const char* data, size_t size, std::string& out) override {
+    return stream_->Update(data, size, out);
+  }
+
+  bool Finish(std::string& out) override { return stream_->Finish(out); }
+
+ private:
+  std::shared_ptr<KeyProvider> keys_;
+  CipherMode mode_;
+  int32_t key_id_;
+  std::unique_ptr<CipherStream> stream_;
+};
+
+// 请求体加密算法在 X-Buried-Cipher 请求头中的名称
+static const char* CipherName(CipherMode mode) {
+  return mode == CipherMode::kAesGcm ? "aes-256-gcm" : "aes-256-cbc";
+}
+
 // 具体实现类，负责埋点数据的加密、存储、定时上报等逻辑
 class BuriedReportImpl {
  public:
   // 构造函数，初始化日志、服务信息、工作目录等
   BuriedReportImpl(std::shared_ptr<spdlog::logger> logger,
-                   CommonService common_service, std::string work_path)
+                   CommonService common_service, std::string work_path,
+                   BuriedReportConfig config)
       : logger_(std::move(logger)),
         common_service_(std::move(common_service)),
-        work_dir_(std::move(work_path)) {
+        work_dir_(std::move(work_path)),
+        config_(config),
+        ring_(std::make_unique<EventRing<BuriedData>>(
+            config.ring_capacity, config.overflow_policy)),
+        http_pool_(std::make_shared<HttpConnectionPool>(
+            Context::GetGlobalContext().GetReportContext(),
+            HttpPoolOptions{config.report_window})),
+        scheduler_(config.scheduler) {
     // 如果没有传入 logger，则创建一个默认的彩色控制台 logger
     if (logger_ == nullptr) {
       logger_ = spdlog::stdout_color_mt("buried");
     }
-    // 生成 AES 密钥并初始化加解密器
-    std::string key = AESCrypt::GetKey("buried_salt", "buried_password");
-    crypt_ = std::make_unique<AESCrypt>(key);
+    // 密钥派生（PBKDF2）放到计算线程上提前进行，不阻塞调用方。
+    // 各线程从对象池借用加解密器，第一次创建时才等待密钥
+    key_provider_ = std::make_shared<KeyProvider>(
+        KeyProvider::Pbkdf2("buried_salt", "buried_password"));
+    crypt_pools_ = std::make_shared<CryptPools>(key_provider_);
+    crypt_pool_ = crypt_pools_->Get(config_.cipher, config_.key_id);
+    boost::asio::post(Context::GetGlobalContext().GetWorkerContext(),
+                      [keys = key_provider_, key_id = config_.key_id]() {
+                        keys->GetKey(key_id);
+                      });
     SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl init success");
     // 在上报 strand 上异步初始化数据库
     Context::GetGlobalContext().GetReportStrand().post([this]() { Init_(); });
   }
 
-  ~BuriedReportImpl() = default;
+  ~BuriedReportImpl();
 
   // 启动定时上报
   void Start();
 
   // 插入一条埋点数据
-  void InsertData(const BuriedData& data);
+  bool InsertData(BuriedData&& data);
+
+  // 批量插入埋点数据
+  bool InsertDatas(std::vector<BuriedData>&& datas);
+
+  uint64_t DroppedCount() const { return ring_->DroppedCount(); }
+
+  uint64_t UnreadableCount() const { return unreadable_count_; }
 
  private:
   // 初始化数据库
   void Init_();
 
-  // 上报缓存中的数据
+  // 确保上报 strand 上有一个待执行的取数任务
+  void ScheduleDrain_();
+
+  // 从环形队列批量取出事件，交给计算线程编码加密，在上报 strand 上执行
+  void DrainRing_();
+
+  // 一个批次编码完成，按取出顺序放入组提交缓冲，在上报 strand 上执行
+  void OnEncoded_(uint64_t seq, std::vector<BuriedDb::Data> rows);
+
+  // 将累积的事件在一个事务内写入数据库
+  void FlushPending_();
+
+  // 析构时在上报 strand 上执行：把环形队列和组提交缓冲中的事件全部落库，
+  // 取消定时器。还有批次在计算线程上编码时返回 false，稍后重试
+  bool Shutdown_();
+
+  // 从数据库加载字符串字典
+  void LoadStrings_();
+
+  // 保存新分配的字典条目，必须先于引用它们的事件落库
+  void SaveStrings_();
+
+  // 按数据记录的加密算法和密钥解密，失败时返回 std::nullopt
+  std::optional<std::string> Decrypt_(int32_t cipher, int32_t key_id,
+                                      const std::vector<char>& content);
+
+  // 生产者线程上查找标题的字典 id，命中时环形队列中只保留 id
+  void InternTitle_(BuriedData& data);
+
+  // 启动组提交定时器，超时后提交累积的事件
+  void ArmFlushTimer_();
+
+  // 上报数据库中的数据
   void ReportCache_();
 
+  // 在窗口允许的范围内取出新批次并发起上报
+  void FillWindow_();
+
+  // 删除超过保留时长或条数上限的无法读取的数据
+  void PurgeUnreadable_();
+
   // 进入下一次上报周期
   void NextCycle_();
 
-  // 将 BuriedData 转换为数据库存储格式
-  BuriedDb::Data MakeDbData_(const BuriedData& data);
+  // 按调度器当前的间隔设置本周期定时器的触发时间
+  void ArmCycleTimer_();
+
+  // 将 BuriedData 转换为数据库存储格式，只包含事件自身的字段，
+  // 按紧凑二进制格式编码后加密。在计算线程上执行，不访问数据库。
+  // 加密失败时记录日志并返回 false，这条数据不落库
+  bool MakeDbData_(BuriedData&& data, Crypt& crypt, BuriedDb::Data& db_data);
+
+  // 生成本次生命周期的公共字段头（加密后）
+  std::vector<char> MakeHeader_();
 
-  // 生成上报用的 JSON 字符串
-  std::string GenReportData_(const std::vector<BuriedDb::Data>& datas);
+  // 取出解密后的公共字段头，优先使用缓存。
+  // 不存在或无法解密时返回空，失败结果不缓存，下一个批次重新读取
+  std::optional<std::string> LoadHeader_(int32_t header_id);
 
-  // 执行 HTTP 上报
-  bool ReportData_(const std::string& data);
+  // 异步执行 HTTP 上报，请求体在计算线程上分段产生，
+  // 完成后在上报 strand 上回调 callback(是否成功)
+  void ReportData_(std::shared_ptr<HttpBodySource> body,
+                   std::function<void(bool)> callback);
+
+  // 一个批次上报完成，在上报 strand 上执行，backlog 表示取批次时还有积压，
+  // unreadable 为批次中无法解密或解码、没有上报的行
+  void OnReportDone_(const std::vector<BuriedDb::Data>& batch,
+                     const std::vector<int32_t>& unreadable, bool backlog,
+                     bool success);
 
  private:
   std::shared_ptr<spdlog::logger> logger_; // 日志器
   std::string work_dir_;                   // 工作目录
-  std::unique_ptr<BuriedDb> db_;           // 数据库对象
+  std::shared_ptr<BuriedDb> db_;           // 数据库对象
+  int32_t header_id_ = BuriedDb::kNoHeader; // 本次生命周期的公共字段头
+  std::unordered_map<int32_t, std::string> headers_; // 已解密的公共字段头
   CommonService common_service_;           // 公共服务信息
-  std::unique_ptr<buried::Crypt> crypt_;   // 加解密器
+  std::shared_ptr<KeyProvider> key_provider_; // 按 id 派生和缓存密钥
+  std::shared_ptr<CryptPools> crypt_pools_; // 各算法和密钥的加解密器对象池
+  CryptPool* crypt_pool_ = nullptr;         // 新数据使用的加密算法
+  // 标题等重复字符串的字典
+  std::shared_ptr<StringDictionary> dictionary_ =
+      std::make_shared<StringDictionary>();
+  std::string process_time_;               // 进程启动时间，进程内不变
 
   std::unique_ptr<boost::asio::deadline_timer> timer_; // 定时器
-
-  std::vector<BuriedDb::Data> data_caches_; // 缓存待上报的数据
+  boost::posix_time::ptime cycle_start_;               // 本周期开始的时间
+  std::chrono::milliseconds cycle_interval_{0};        // 定时器使用的间隔
+
+  BuriedReportConfig config_;                       // 上报参数
+  std::unique_ptr<EventRing<BuriedData>> ring_;     // 生产者写入的环形队列
+  std::atomic<bool> drain_scheduled_{false};        // 是否已投递取数任务
+  size_t encoding_chunks_ = 0;                      // 正在编码的批次数
+  uint64_t next_encode_seq_ = 0;                    // 下一个取出批次的序号
+  uint64_t next_commit_seq_ = 0;                    // 下一个应提交批次的序号
+  std::map<uint64_t, std::vector<BuriedDb::Data>> encoded_; // 提前完成的批次
+  uint64_t reported_dropped_ = 0;                   // 已记录日志的丢弃数
+  std::atomic<uint64_t> unreadable_count_{0};       // 标记为无法读取的行数
+
+  std::shared_ptr<HttpConnectionPool> http_pool_;   // 上报复用的长连接池
+  size_t in_flight_batches_ = 0;                    // 未完成的上报批次数
+  ReportScheduler scheduler_;                       // 自适应批次和间隔
+
+  std::vector<BuriedDb::Data> pending_rows_;                 // 等待组提交的数据
+  std::unique_ptr<boost::asio::steady_timer> flush_timer_;   // 组提交定时器
+  bool flush_timer_armed_ = false;                           // 定时器是否在等待
+
+  // 析构开始后不再接受新事件
+  std::atomic<bool> stopping_{false};
+  // 引用 this 的异步任务通过 alive_ 判断对象是否还在，
+  // lifetime_ 只在上报 strand 上释放，此后 strand 上的任务不再访问 this
+  std::shared_ptr<bool> lifetime_ = std::make_shared<bool>(true);
+  const std::weak_ptr<bool> alive_ = lifetime_;
 };
 
+// 等待计算线程上的编码批次回到 strand 后，在 strand 上同步落库并释放 lifetime_。
+// 之后仍在排队的定时器回调和上报回调都会因为 alive_ 失效而直接返回。
+// 不能在上报 strand 上析构
+BuriedReportImpl::~BuriedReportImpl() {
+  stopping_.store(true, std::memory_order_release);
+  for (;;) {
+    std::promise<bool> promise;
+    auto done = promise.get_future();
+    Context::GetGlobalContext().GetReportStrand().post(
+        [this, &promise]() { promise.set_value(Shutdown_()); });
+    if (done.get()) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+bool BuriedReportImpl::Shutdown_() {
+  if (encoding_chunks_ > 0) {
+    return false;
+  }
+  // 所有编码批次都已按顺序进入 pending_rows_，剩下的事件直接在 strand 上编码
+  if (db_) {
+    std::vector<BuriedData> rest;
+    ring_->PopBatch(rest, ring_->Capacity());
+    Crypt& crypt = crypt_pool_->Local();
+    for (auto& data : rest) {
+      BuriedDb::Data row;
+      if (MakeDbData_(std::move(data), crypt, row)) {
+        pending_rows_.push_back(std::move(row));
+      }
+    }
+    FlushPending_();
+  }
+  if (timer_) {
+    timer_->cancel();
+  }
+  if (flush_timer_) {
+    flush_timer_->cancel();
+  }
+  lifetime_.reset();
+  return true;
+}
+
 // 数据库初始化，设置路径并创建数据库对象
 void BuriedReportImpl::Init_() {
   std::filesystem::path db_path = work_dir_;
   SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl init db path: {}",
                      db_path.string());
   db_path /= kDbName;
-  db_ = std::make_unique<BuriedDb>(db_path.string());
+  db_ = std::make_shared<BuriedDb>(db_path.string(), config_.storage_profile);
+  LoadStrings_();
+  // 进程启动时间每次启动都不同，内联保存，不占用永久的字典条目
+  process_time_ = CommonService::GetProcessTime();
+  // 上次退出时还没确认的批次重新等待上报
+  db_->ResetInFlight();
+  int32_t unreadable = db_->CountUnreadable();
+  if (unreadable > 0) {
+    SPDLOG_LOGGER_WARN(logger_,
+                       "BuriedReportImpl {} unreadable rows in database",
+                       unreadable);
+  }
+  // 公共字段每次启动只存一份，旧的公共字段头在引用它的数据上报完后清理
+  header_id_ = db_->InsertHeader(
+      MakeHeader_(), static_cast<int32_t>(config_.cipher), config_.key_id);
+  db_->DeleteUnusedHeaders(header_id_);
+  flush_timer_ = std::make_unique<boost::asio::steady_timer>(
+      Context::GetGlobalContext().GetMainContext());
 }
 
 // 启动定时器，定时触发上报逻辑
 void BuriedReportImpl::Start() {
   SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl start");
 
-  // 创建定时器，5秒后触发
+  // 创建定时器，第一次按正常上报间隔触发
   timer_ = std::make_unique<boost::asio::deadline_timer>(
-      Context::GetGlobalContext().GetMainContext(),
-      boost::posix_time::seconds(5));
+      Context::GetGlobalContext().GetMainContext());
+  NextCycle_();
+}
 
-  // 异步等待，回调在上报 strand 上执行
-  timer_->async_wait(Context::GetGlobalContext().GetReportStrand().wrap(
-      [this](const boost::system::error_code& ec) {
+// 插入数据，只写入无锁环形队列，落库在上报 strand 上批量进行
+// 被丢弃的事件在下一次取数时汇总记录日志
+bool BuriedReportImpl::InsertData(BuriedData&& data) {
+  if (stopping_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  InternTitle_(data);
+  if (!ring_->Push(std::move(data))) {
+    return false;
+  }
+  ScheduleDrain_();
+  return true;
+}
+
+// 整批连续写入环形队列，取数时落在同一个组提交事务里
+bool BuriedReportImpl::InsertDatas(std::vector<BuriedData>&& datas) {
+  if (stopping_.load(std::memory_order_acquire)) {
+    return datas.empty();
+  }
+  for (auto& data : datas) {
+    InternTitle_(data);
+  }
+  size_t pushed = ring_->PushBulk(datas.data(), datas.size());
+  if (pushed == 0) {
+    return datas.empty();
+  }
+  ScheduleDrain_();
+  return pushed == datas.size();
+}
+
+// 只有第一个发现没有待执行取数任务的生产者才会 post，避免每个事件一次 post
+void BuriedReportImpl::ScheduleDrain_() {
+  if (drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  Context::GetGlobalContext().GetReportStrand().post(
+      [this, alive = alive_]() {
+        if (!alive.expired()) {
+          DrainRing_();
+        }
+      });
+}
+
+// 编码批次数达到上限时停止取数，由 OnEncoded_ 继续
+void BuriedReportImpl::DrainRing_() {
+  // 先清除标记再取数，之后写入的事件会触发新的取数任务
+  drain_scheduled_.exchange(false, std::memory_order_acq_rel);
+  while (encoding_chunks_ < kMaxEncodingChunks) {
+    auto chunk = std::make_shared<std::vector<BuriedData>>();
+    if (ring_->PopBatch(*chunk, config_.drain_batch_size) == 0) {
+      break;
+    }
+    ++encoding_chunks_;
+    uint64_t seq = next_encode_seq_++;
+    boost::asio::post(
+        Context::GetGlobalContext().GetWorkerContext(), [this, chunk, seq]() {
+          std::vector<BuriedDb::Data> rows;
+          rows.reserve(chunk->size());
+          Crypt& crypt = crypt_pool_->Local();
+          for (auto& data : *chunk) {
+            BuriedDb::Data row;
+            if (MakeDbData_(std::move(data), crypt, row)) {
+              rows.push_back(std::move(row));
+            }
+          }
+          Context::GetGlobalContext().GetReportStrand().post(
+              [this, seq, rows = std::move(rows)]() mutable {
+                OnEncoded_(seq, std::move(rows));
+              });
+        });
+  }
+
+  uint64_t dropped = ring_->DroppedCount();
+  if (dropped != reported_dropped_) {
+    SPDLOG_LOGGER_WARN(logger_, "BuriedReportImpl ring overflow, dropped: {}",
+                       dropped - reported_dropped_);
+    reported_dropped_ = dropped;
+  }
+}
+
+// 计算线程完成的顺序不确定，按序号重新排好后才进入组提交，保证写入顺序
+void BuriedReportImpl::OnEncoded_(uint64_t seq,
+                                  std::vector<BuriedDb::Data> rows) {
+  --encoding_chunks_;
+  encoded_.emplace(seq, std::move(rows));
+  for (auto iter = encoded_.begin();
+       iter != encoded_.end() && iter->first == next_commit_seq_;
+       iter = encoded_.erase(iter), ++next_commit_seq_) {
+    pending_rows_.insert(pending_rows_.end(),
+                         std::make_move_iterator(iter->second.begin()),
+                         std::make_move_iterator(iter->second.end()));
+  }
+  if (!config_.group_commit ||
+      pending_rows_.size() >= config_.group_commit_rows) {
+    FlushPending_();
+  }
+  if (!pending_rows_.empty()) {
+    ArmFlushTimer_();
+  }
+  // 取数曾因编码批次已满而暂停
+  if (ring_->Size() > 0) {
+    DrainRing_();
+  }
+}
+
+void BuriedReportImpl::FlushPending_() {
+  if (pending_rows_.empty()) {
+    return;
+  }
+  SaveStrings_();
+  db_->InsertDatas(pending_rows_);
+  pending_rows_.clear();
+}
+
+// 字典条目和事件一样加密存储，标题不以明文出现在数据库中。
+// 无法解密的条目只占住 id，引用它的事件上报时无法解码，标记为无法读取
+void BuriedReportImpl::LoadStrings_() {
+  for (const auto& string : db_->QueryStrings()) {
+    auto id = static_cast<uint32_t>(string.id);
+    auto value = Decrypt_(string.cipher, string.key_id, string.content);
+    if (!value) {
+      SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl decrypt string {} failed",
+                          string.id);
+      dictionary_->Reserve(id);
+      continue;
+    }
+    dictionary_->Load(id, std::move(*value));
+  }
+}
+
+// 计算线程在编码前分配 id，这里保存的条目覆盖了已编码完成的全部事件
+void BuriedReportImpl::SaveStrings_() {
+  auto entries = dictionary_->TakeUnsaved();
+  if (entries.empty()) {
+    return;
+  }
+  std::vector<BuriedDb::DictString> strings;
+  strings.reserve(entries.size());
+  auto crypt = crypt_pool_->Acquire();
+  for (const auto& [id, value] : entries) {
+    std::string content = crypt->Encrypt(value);
+    strings.push_back(BuriedDb::DictString{
+        static_cast<int32_t>(id),
+        std::vector<char>(content.begin(), content.end()),
+        static_cast<int32_t>(config_.cipher), config_.key_id});
+  }
+  db_->InsertStrings(strings);
+}
+
+// 用 DecryptInto 区分解密失败和明文本身为空
+std::optional<std::string> BuriedReportImpl::Decrypt_(
+    int32_t cipher, int32_t key_id, const std::vector<char>& content) {
+  CryptPool* pool = crypt_pools_->Get(cipher, key_id);
+  if (pool == nullptr) {
+    SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl unknown cipher {}", cipher);
+    return std::nullopt;
+  }
+  auto crypt = pool->Acquire();
+  std::string plain(crypt->DecryptedSize(content.size()), '\0');
+  size_t written = 0;
+  if (!crypt->DecryptInto(std::as_bytes(std::span(content)),
+                          std::as_writable_bytes(std::span(plain)), written)) {
+    return std::nullopt;
+  }
+  plain.resize(written);
+  return plain;
+}
+
+// 只查找不分配，新标题在计算线程上分配 id
+void BuriedReportImpl::InternTitle_(BuriedData& data) {
+  if (data.title_id != 0) {
+    return;
+  }
+  data.title_id = dictionary_->Find(data.title);
+  if (data.title_id != 0) {
+    std::string().swap(data.title);
+  }
+}
+
+// 定时器已在等待时不重复启动，超时后提交这段时间内累积的全部事件
+void BuriedReportImpl::ArmFlushTimer_() {
+  if (flush_timer_armed_) {
+    return;
+  }
+  flush_timer_armed_ = true;
+  flush_timer_->expires_after(
+      std::chrono::milliseconds(config_.group_commit_interval_ms));
+  flush_timer_->async_wait(Context::GetGlobalContext().GetReportStrand().wrap(
+      [this, alive = alive_](const boost::system::error_code& ec) {
+        if (alive.expired()) {
+          return;
+        }
+        flush_timer_armed_ = false;
         if (ec) {
-          logger_->error("BuriedReportImpl::Start error: {}", ec.message());
+          logger_->error("BuriedReportImpl::ArmFlushTimer_ error: {}",
+                         ec.message());
           return;
         }
-        ReportCache_();
+        FlushPending_();
       }));
 }
 
-// 插入数据，实际操作在上报 strand 上异步执行
-void BuriedReportImpl::InsertData(const BuriedData& data) {
-  Context::GetGlobalContext().GetReportStrand().post(
-      [this, data]() { db_->InsertData(MakeDbData_(data)); });
-}
-
 // 执行 HTTP 上报，返回是否成功
-bool BuriedReportImpl::ReportData_(const std::string& data) {
+// 网络 I/O 在上报 io_context 上异步进行，不占用上报 strand
+void BuriedReportImpl::ReportData_(std::shared_ptr<HttpBodySource> body,
+                                   std::function<void(bool)> callback) {
   HttpReporter reporter(logger_);
-  return reporter.Host(common_service_.host)
+  reporter.Host(common_service_.host)
       .Topic(common_service_.topic)
       .Port(common_service_.port)
-      .Body(data)
-      .Report();
+      .BodySource(std::move(body),
+                  &Context::GetGlobalContext().GetWorkerContext())
+      .Pool(http_pool_)
+      .Timeouts(config_.http_timeouts)
+      .Compression(config_.compression);
+  if (config_.encrypt_body) {
+    reporter
+        .Filter(std::make_shared<CipherBodyFilter>(key_provider_,
+                                                   config_.cipher,
+                                                   config_.key_id))
+        .Header("X-Buried-Cipher", CipherName(config_.cipher))
+        .Header("X-Buried-Key-Id", std::to_string(config_.key_id));
+  }
+  reporter.AsyncReport([callback = std::move(callback)](bool success) {
+    Context::GetGlobalContext().GetReportStrand().post(
+        [callback, success]() { callback(success); });
+  });
 }
 
-// 上报缓存中的数据，如果上报成功则从数据库删除
+// 上报数据库中的数据，上报请求在途时插入仍可继续在 strand 上执行
 void BuriedReportImpl::ReportCache_() {
   SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl report cache");
-  // 如果缓存为空，从数据库查询最多10条数据
-  if (data_caches_.empty()) {
-    data_caches_ = db_->QueryData(10);
+  // 先提交还在组提交缓冲里的数据，让本次上报能查到
+  FlushPending_();
+  PurgeUnreadable_();
+
+  scheduler_.OnCycle();
+  FillWindow_();
+
+  // 进入下一次上报周期
+  NextCycle_();
+}
+
+void BuriedReportImpl::PurgeUnreadable_() {
+  uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+  uint64_t ttl = uint64_t{config_.unreadable_ttl_hours} * 3600 * 1000;
+  int32_t purged = db_->PurgeUnreadable(now > ttl ? now - ttl : 0,
+                                        config_.max_unreadable_rows);
+  if (purged > 0) {
+    SPDLOG_LOGGER_WARN(logger_, "BuriedReportImpl purged {} unreadable rows",
+                       purged);
   }
+}
 
-  // 如果有数据，生成上报内容并尝试上报
-  if (!data_caches_.empty()) {
-    std::string report_data = GenReportData_(data_caches_);
-    if (ReportData_(report_data)) {
-      db_->DeleteDatas(data_caches_); // 上报成功则删除
-      data_caches_.clear();
+// 每个批次先在数据库中标记为上报中，避免被后续批次重复取出
+void BuriedReportImpl::FillWindow_() {
+  while (in_flight_batches_ < config_.report_window) {
+    // 批次行数由调度器决定，再按字节上限截断，至少保留一行。
+    // 这里只读取摘要，内容在发送时分页读取
+    int32_t rows = scheduler_.BatchRows();
+    auto summaries = db_->QuerySummaries(rows);
+    if (summaries.empty()) {
+      break;
     }
+    bool backlog = summaries.size() == static_cast<size_t>(rows);
+    // 一个批次只能带一个公共字段头，遇到其他头的数据留给后续批次
+    int32_t header_id = summaries.front().header_id;
+    size_t bytes = 0;
+    auto batch = std::make_shared<std::vector<BuriedDb::Data>>();
+    std::vector<int32_t> ids;
+    for (const auto& summary : summaries) {
+      bytes += summary.size;
+      if (!ids.empty() && (bytes > scheduler_.MaxBatchBytes() ||
+                           summary.header_id != header_id)) {
+        backlog = true;
+        break;
+      }
+      ids.push_back(summary.id);
+      batch->push_back(BuriedDb::Data{summary.id, summary.priority, 0, {}});
+    }
+    db_->MarkInFlight(*batch);
+    ++in_flight_batches_;
+    // 公共字段头在 strand 上读取，事件内容由计算线程在发送时读取和解密
+    std::optional<std::string> header;
+    if (header_id != BuriedDb::kNoHeader) {
+      header = LoadHeader_(header_id);
+    }
+    auto body = std::make_shared<BatchBodySource>(
+        logger_, db_, crypt_pools_, dictionary_, std::move(ids),
+        std::move(header), header_id != BuriedDb::kNoHeader,
+        config_.quote_events, config_.wire_dictionary);
+    // 析构后才完成的批次保持上报中，下次启动时恢复为等待上报
+    ReportData_(body, [this, alive = alive_, batch, body,
+                       backlog](bool success) {
+      if (!alive.expired()) {
+        OnReportDone_(*batch, body->Unreadable(), backlog, success);
+      }
+    });
   }
+}
 
-  // 进入下一次上报周期
-  NextCycle_();
+// 每个批次只在收到自己的确认后删除，失败的批次恢复为等待上报。
+// 无法读取的行没有被服务端收到，保留在数据库中但不再上报
+void BuriedReportImpl::OnReportDone_(const std::vector<BuriedDb::Data>& batch,
+                                     const std::vector<int32_t>& unreadable,
+                                     bool backlog, bool success) {
+  --in_flight_batches_;
+  if (!success) {
+    db_->MarkPending(batch);
+    scheduler_.OnFailure();
+    SPDLOG_LOGGER_WARN(logger_, "BuriedReportImpl report failed, retry in {}ms",
+                       scheduler_.Interval().count());
+    ArmCycleTimer_();
+    return;
+  }
+  if (unreadable.empty()) {
+    db_->DeleteDatas(batch);
+  } else {
+    std::vector<BuriedDb::Data> delivered;
+    std::vector<BuriedDb::Data> kept;
+    for (const auto& data : batch) {
+      bool skipped = std::find(unreadable.begin(), unreadable.end(),
+                               data.id) != unreadable.end();
+      (skipped ? kept : delivered).push_back(data);
+    }
+    db_->DeleteDatas(delivered);
+    db_->MarkUnreadable(kept);
+    unreadable_count_ += kept.size();
+    SPDLOG_LOGGER_WARN(logger_,
+                       "BuriedReportImpl {} unreadable rows kept in database, "
+                       "{} since start",
+                       kept.size(), unreadable_count_.load());
+  }
+  scheduler_.OnSuccess(backlog);
+  // 只有积压时才不等下个周期立即补满窗口，否则按周期攒批，避免零碎的小请求
+  if (backlog) {
+    FillWindow_();
+  }
+  ArmCycleTimer_();
 }
 
-// 将数据库数据解密并组装为 JSON 数组字符串
-std::string BuriedReportImpl::GenReportData_(
-    const std::vector<BuriedDb::Data>& datas) {
-  nlohmann::json json_datas;
-  for (const auto& data : datas) {
-    std::string content =
-        crypt_->Decrypt(data.content.data(), data.content.size());
-    SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl report data content size: {}",
-                       data.content.size());
-    json_datas.push_back(content);
+std::optional<std::string> BuriedReportImpl::LoadHeader_(int32_t header_id) {
+  auto iter = headers_.find(header_id);
+  if (iter != headers_.end()) {
+    return iter->second;
   }
-  std::string ret = json_datas.dump();
-  return ret;
+  BuriedDb::Header header;
+  if (!db_->QueryHeader(header_id, header)) {
+    SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl header {} not found",
+                        header_id);
+    return std::nullopt;
+  }
+  auto content = Decrypt_(header.cipher, header.key_id, header.content);
+  if (!content || content->empty()) {
+    SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl decrypt header {} failed",
+                        header_id);
+    return std::nullopt;
+  }
+  headers_.emplace(header_id, *content);
+  return content;
 }
 
-// 将 BuriedData 转换为数据库存储格式，并加密内容
-BuriedDb::Data BuriedReportImpl::MakeDbData_(const BuriedData& data) {
-  BuriedDb::Data db_data;
-  db_data.id = -1;
-  db_data.priority = data.priority;
-  db_data.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          std::chrono::system_clock::now().time_since_epoch())
-                          .count();
+// 公共字段在一次生命周期内不变，加密后作为公共字段头存储
+std::vector<char> BuriedReportImpl::MakeHeader_() {
   nlohmann::json json_data;
-  json_data["title"] = data.title;
-  json_data["data"] = data.data;
   json_data["user_id"] = common_service_.user_id;
   json_data["app_version"] = common_service_.app_version;
   json_data["app_name"] = common_service_.app_name;
@@ -178,49 +861,117 @@ BuriedDb::Data BuriedReportImpl::MakeDbData_(const BuriedData& data) {
   json_data["device_id"] = common_service_.device_id;
   json_data["buried_version"] = common_service_.buried_version;
   json_data["lifecycle_id"] = common_service_.lifecycle_id;
-  json_data["priority"] = data.priority;
-  json_data["timestamp"] = CommonService::GetNowDate();
-  json_data["process_time"] = CommonService::GetProcessTime();
-  json_data["report_id"] = CommonService::GetRandomId();
-  // 加密 JSON 字符串
-  std::string report_data = crypt_->Encrypt(json_data.dump());
-  db_data.content = std::vector<char>(report_data.begin(), report_data.end());
+  std::string header = crypt_pool_->Acquire()->Encrypt(json_data.dump());
+  return std::vector<char>(header.begin(), header.end());
+}
+
+// 将 BuriedData 转换为数据库存储格式，并加密内容。
+// 事件时间就是行的 timestamp 列，编码后的时间差为 0，只占一个字节；
+// 标题和进程启动时间在字典中时只保存 id
+bool BuriedReportImpl::MakeDbData_(BuriedData&& data, Crypt& crypt,
+                                   BuriedDb::Data& db_data) {
+  db_data.id = -1;
+  db_data.priority = data.priority;
+  db_data.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  db_data.header_id = header_id_;
+  db_data.cipher = static_cast<int32_t>(config_.cipher);
+  db_data.key_id = config_.key_id;
+  std::string report_id = CommonService::GetRandomId();
+  RowEvent event;
+  event.flags = data.data_is_json ? kRowDataIsJson : 0;
+  event.title_id =
+      data.title_id != 0 ? data.title_id : dictionary_->Intern(data.title);
+  event.title = data.title;
+  event.data = data.data;
+  event.priority = data.priority;
+  event.timestamp = db_data.timestamp;
+  event.process_time = process_time_;
+  event.report_id = report_id;
+  // 编码缓冲区按线程复用，加密结果直接写入行内容
+  thread_local std::string row;
+  row.clear();
+  EncodeRow(event, db_data.timestamp, row);
+  db_data.content.resize(crypt.EncryptedSize(row.size()));
+  size_t written = 0;
+  if (!crypt.EncryptInto(std::as_bytes(std::span(row)),
+                         std::as_writable_bytes(std::span(db_data.content)),
+                         written)) {
+    SPDLOG_LOGGER_ERROR(logger_, "BuriedReportImpl encrypt data {} failed",
+                        report_id);
+    return false;
+  }
+  db_data.content.resize(written);
   SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl insert data size: {}",
                      db_data.content.size());
 
-  return db_data;
+  return true;
 }
 
-// 进入下一次上报周期，定时器顺延5秒
+// 进入下一次上报周期
 void BuriedReportImpl::NextCycle_() {
   SPDLOG_LOGGER_INFO(logger_, "BuriedReportImpl next cycle");
-  timer_->expires_at(timer_->expires_at() + boost::posix_time::seconds(5));
-  timer_->async_wait([this](const boost::system::error_code& ec) {
-    if (ec) {
-      logger_->error("BuriedReportImpl::NextCycle_ error: {}", ec.message());
-      return;
-    }
-    // 下一次上报逻辑仍然在上报 strand 上执行
-    Context::GetGlobalContext().GetReportStrand().post(
-        [this]() { ReportCache_(); });
-  });
+  cycle_start_ = boost::asio::deadline_timer::traits_type::now();
+  cycle_interval_ = std::chrono::milliseconds(-1);
+  ArmCycleTimer_();
+}
+
+// 间隔由调度器根据积压和失败情况调整。批次上报完成后间隔变化时重新设置，
+// 退避或加速在本周期内就生效，而不是晚一个周期
+void BuriedReportImpl::ArmCycleTimer_() {
+  if (scheduler_.Interval() == cycle_interval_) {
+    return;
+  }
+  cycle_interval_ = scheduler_.Interval();
+  // 重新设置触发时间会取消之前的等待，已经过了新的触发时间时立即触发
+  timer_->expires_at(cycle_start_ + boost::posix_time::milliseconds(
+                                        cycle_interval_.count()));
+  // 下一次上报逻辑仍然在上报 strand 上执行
+  timer_->async_wait(Context::GetGlobalContext().GetReportStrand().wrap(
+      [this, alive = alive_](const boost::system::error_code& ec) {
+        if (alive.expired() || ec == boost::asio::error::operation_aborted) {
+          return;
+        }
+        if (ec) {
+          logger_->error("BuriedReportImpl::NextCycle_ error: {}",
+                         ec.message());
+          return;
+        }
+        ReportCache_();
+      }));
 }
 
 // =================== BuriedReport 外部接口实现 ===================
 
 // 构造函数，创建实现对象
 BuriedReport::BuriedReport(std::shared_ptr<spdlog::logger> logger,
-                           CommonService common_service, std::string work_path)
+                           CommonService common_service, std::string work_path,
+                           BuriedReportConfig config)
     : impl_(std::make_unique<BuriedReportImpl>(
-          std::move(logger), std::move(common_service), std::move(work_path))) {
-}
+          std::move(logger), std::move(common_service), std::move(work_path),
+          config)) {}
 
 // 启动上报
 void BuriedReport::Start() { impl_->Start(); }
 
 // 插入埋点数据
-void BuriedReport::InsertData(const BuriedData& data) {
-  impl_->InsertData(data);
+bool BuriedReport::InsertData(const BuriedData& data) {
+  return impl_->InsertData(BuriedData(data));
+}
+
+bool BuriedReport::InsertData(BuriedData&& data) {
+  return impl_->InsertData(std::move(data));
+}
+
+bool BuriedReport::InsertDatas(std::vector<BuriedData>&& datas) {
+  return impl_->InsertDatas(std::move(datas));
+}
+
+uint64_t BuriedReport::DroppedCount() const { return impl_->DroppedCount(); }
+
+uint64_t BuriedReport::UnreadableCount() const {
+  return impl_->UnreadableCount();
 }
 
 // 析构函数
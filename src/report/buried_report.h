@@ -4,8 +4,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/common_service.h"
+#include "crypt/crypt.h"
+#include "database/database.h"
+#include "report/http_report.h"
+#include "report/report_scheduler.h"
+#include "report/event_ring.h"
 
 namespace spdlog {
 class logger;
@@ -17,19 +23,83 @@ struct BuriedData {
   std::string title;
   std::string data;
   uint32_t priority;
+  bool data_is_json = false;  // data 已经是 JSON 对象，落库时原样嵌入而不转义
+  uint32_t title_id = 0;      // 标题在字符串字典中的 id，不为 0 时忽略 title
+};
+
+// 上报模块的可调参数
+struct BuriedReportConfig {
+  // 内存环形队列容量（向上取整为 2 的幂）
+  size_t ring_capacity = 8192;
+  // 环形队列写满时的处理策略。默认丢弃新事件，InsertData 不会阻塞，
+  // 丢弃的事件通过返回值和 DroppedCount 告知调用方。
+  // kBlock 下不能在上报 strand 上调用 InsertData，否则会等待自己取数
+  OverflowPolicy overflow_policy = OverflowPolicy::kDrop;
+  // 上报 strand 每次从环形队列取出的最大事件数
+  size_t drain_batch_size = 256;
+  // 组提交：合并多个事件到一个数据库事务，
+  // 累积 group_commit_rows 条或等待 group_commit_interval_ms 毫秒后提交
+  bool group_commit = true;
+  size_t group_commit_rows = 512;
+  uint32_t group_commit_interval_ms = 200;
+  // 事件数据库的存储档位
+  BuriedDb::StorageProfile storage_profile =
+      BuriedDb::StorageProfile::kBalanced;
+  // 异步上报各阶段的超时时间
+  HttpTimeouts http_timeouts;
+  // 同时在途的上报批次数，各批次分散在连接池的不同连接上
+  size_t report_window = 4;
+  // 自适应批次大小和上报间隔
+  ReportSchedulerOptions scheduler;
+  // 请求体压缩，默认不压缩；改为 gzip 或 deflate 前需要确认服务端
+  // 支持解码对应的 Content-Encoding
+  HttpCompression compression{HttpEncoding::kIdentity};
+  // 事件以 JSON 字符串（而不是 JSON 对象）放入请求体，兼容旧版服务端，
+  // 开启后每个事件需要额外转义一次
+  bool quote_events = false;
+  // 上报时事件的标题等字典字符串写为 "title_id" 这样的 id，
+  // 批次附带 "strings": {"id": "字符串"}，需要服务端支持
+  bool wire_dictionary = false;
+  // 新数据的加密算法，已存储的数据按各自记录的算法解密。
+  // GCM 带完整性校验，但每条数据多 28 字节，mbedtls 下也比 CBC 慢
+  CipherMode cipher = CipherMode::kAesCbc;
+  // 新数据的密钥 id，轮换密钥时递增，0 为旧版本使用的密钥
+  int32_t key_id = 0;
+  // 上报时用 cipher 和 key_id 对压缩后的请求体整体流式加密，
+  // 通过 X-Buried-Cipher 和 X-Buried-Key-Id 请求头告知服务端，需要服务端支持
+  bool encrypt_body = false;
+  // 无法解密或解码的数据保留在数据库中便于排查，
+  // 超过保留时长或条数上限后在上报周期中删除
+  uint32_t unreadable_ttl_hours = 72;
+  int32_t max_unreadable_rows = 1000;
 };
 
 class BuriedReportImpl;
 class BuriedReport {
  public:
   BuriedReport(std::shared_ptr<spdlog::logger> logger,
-               CommonService common_service, std::string work_path);
+               CommonService common_service, std::string work_path,
+               BuriedReportConfig config = BuriedReportConfig());
 
   ~BuriedReport();
 
   void Start();
 
-  void InsertData(const BuriedData& data);
+  // 返回 false 表示环形队列已满，事件按溢出策略被丢弃
+  bool InsertData(const BuriedData& data);
+
+  // 移动版本，title 和 data 不再复制
+  bool InsertData(BuriedData&& data);
+
+  // 批量插入，整批一次写入环形队列，只投递一次取数任务。
+  // 有任何一个事件被丢弃时返回 false
+  bool InsertDatas(std::vector<BuriedData>&& datas);
+
+  // 因环形队列写满被丢弃的事件总数
+  uint64_t DroppedCount() const;
+
+  // 本次启动以来上报时无法解密或解码、被标记为不再上报的数据总数
+  uint64_t UnreadableCount() const;
 
  private:
   std::unique_ptr<BuriedReportImpl> impl_;
@@ -0,0 +1,194 @@
+#include "report/event_builder.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace buried {
+
+// U+FFFD 的 UTF-8 编码
+static const char kReplacement[] = "\xEF\xBF\xBD";
+
+// 检查 value[pos] 开始的多字节 UTF-8 序列，合法时返回序列长度。
+// 不合法时返回 0，skip 为需要替换的最长非法前缀的字节数（至少为 1）
+static size_t Utf8Sequence(std::string_view value, size_t pos, size_t& skip) {
+  unsigned char lead = static_cast<unsigned char>(value[pos]);
+  size_t need = 0;
+  unsigned char low = 0x80;
+  unsigned char high = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    need = 1;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    // 排除过长编码和代理区
+    need = 2;
+    low = lead == 0xE0 ? 0xA0 : 0x80;
+    high = lead == 0xED ? 0x9F : 0xBF;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    // 排除过长编码和超过 U+10FFFF 的码点
+    need = 3;
+    low = lead == 0xF0 ? 0x90 : 0x80;
+    high = lead == 0xF4 ? 0x8F : 0xBF;
+  } else {
+    skip = 1;
+    return 0;
+  }
+  size_t count = 1;
+  for (; count <= need && pos + count < value.size(); ++count) {
+    unsigned char ch = static_cast<unsigned char>(value[pos + count]);
+    if (ch < low || ch > high) {
+      break;
+    }
+    low = 0x80;
+    high = 0xBF;
+  }
+  if (count > need) {
+    return count;
+  }
+  skip = count;
+  return 0;
+}
+
+void RepairUtf8(std::string& value) {
+  size_t pos = 0;
+  size_t skip = 0;
+  while (pos < value.size()) {
+    if (static_cast<unsigned char>(value[pos]) < 0x80) {
+      ++pos;
+      continue;
+    }
+    size_t length = Utf8Sequence(value, pos, skip);
+    if (length == 0) {
+      break;
+    }
+    pos += length;
+  }
+  if (pos == value.size()) {
+    return;
+  }
+  // 从第一个非法字节开始重新拼接
+  std::string repaired(value, 0, pos);
+  while (pos < value.size()) {
+    if (static_cast<unsigned char>(value[pos]) < 0x80) {
+      repaired += value[pos++];
+      continue;
+    }
+    size_t length = Utf8Sequence(value, pos, skip);
+    if (length > 0) {
+      repaired.append(value, pos, length);
+      pos += length;
+    } else {
+      repaired += kReplacement;
+      pos += skip;
+    }
+  }
+  value = std::move(repaired);
+}
+
+void AppendJsonString(std::string& out, std::string_view value) {
+  static const char kHex[] = "0123456789abcdef";
+  out.reserve(out.size() + value.size() + 2);
+  out += '"';
+  for (size_t pos = 0; pos < value.size(); ++pos) {
+    char ch = value[pos];
+    if (static_cast<unsigned char>(ch) >= 0x80) {
+      // 合法的 UTF-8 多字节字符原样保留，非法字节替换为 U+FFFD
+      size_t skip = 0;
+      size_t length = Utf8Sequence(value, pos, skip);
+      if (length > 0) {
+        out.append(value.data() + pos, length);
+        pos += length - 1;
+      } else {
+        out += kReplacement;
+        pos += skip - 1;
+      }
+      continue;
+    }
+    switch (ch) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(ch) < 0x20) {
+          // 其他控制字符写成 \u00XX
+          out += "\\u00";
+          out += kHex[(ch >> 4) & 0xf];
+          out += kHex[ch & 0xf];
+        } else {
+          out += ch;
+        }
+        break;
+    }
+  }
+  out += '"';
+}
+
+// key 和字符串值在 AppendJsonString 中替换，标题在这里替换，
+// Finish 得到的事件不需要在落库或上报时再检查
+EventBuilder::EventBuilder(std::string title, uint32_t priority) {
+  RepairUtf8(title);
+  data_.title = std::move(title);
+  data_.priority = priority;
+  data_.data_is_json = true;
+  data_.data = "{";
+}
+
+void EventBuilder::AddInt(std::string_view key, int64_t value) {
+  AppendKey_(key);
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  data_.data.append(buffer, result.ptr);
+}
+
+void EventBuilder::AddDouble(std::string_view key, double value) {
+  AppendKey_(key);
+  if (!std::isfinite(value)) {
+    data_.data += "null";
+    return;
+  }
+  // 最短且能精确还原的十进制表示
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  data_.data.append(buffer, result.ptr);
+}
+
+void EventBuilder::AddBool(std::string_view key, bool value) {
+  AppendKey_(key);
+  data_.data += value ? "true" : "false";
+}
+
+void EventBuilder::AddString(std::string_view key, std::string_view value) {
+  AppendKey_(key);
+  AppendJsonString(data_.data, value);
+}
+
+BuriedData EventBuilder::Finish() {
+  data_.data += '}';
+  return std::move(data_);
+}
+
+void EventBuilder::AppendKey_(std::string_view key) {
+  if (data_.data.size() > 1) {
+    data_.data += ',';
+  }
+  AppendJsonString(data_.data, key);
+  data_.data += ':';
+}
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+#include "report/buried_report.h"
+
+namespace buried {
+
+// 把 value 中非法的 UTF-8 字节序列替换为 U+FFFD，合法时不分配内存
+void RepairUtf8(std::string& value);
+
+// 把 value 作为带引号的 JSON 字符串追加到 out，按 JSON 规则转义。
+// 非法的 UTF-8 字节序列替换为 U+FFFD，保证输出总是合法的 JSON
+void AppendJsonString(std::string& out, std::string_view value);
+
+// 结构化事件构造器：属性按类型直接写成 JSON 对象，调用方不需要先把 data
+// 序列化成字符串，落库时也不会再被当作字符串转义一次。
+// 标题、key 和字符串值中非法的 UTF-8 在构造时替换为 U+FFFD，
+// data 总是合法的 JSON。不检查重复的 key，非线程安全
+class EventBuilder {
+ public:
+  EventBuilder(std::string title, uint32_t priority);
+
+  void AddInt(std::string_view key, int64_t value);
+
+  // NaN 和无穷大不是合法的 JSON 数字，写为 null
+  void AddDouble(std::string_view key, double value);
+
+  void AddBool(std::string_view key, bool value);
+
+  void AddString(std::string_view key, std::string_view value);
+
+  // 结束构造，返回的 BuriedData 的 data 是一个 JSON 对象。之后不能再添加属性
+  BuriedData Finish();
+
+ private:
+  void AppendKey_(std::string_view key);
+
+ private:
+  BuriedData data_;
+};
+
+}  // namespace buried
\ No newline at end of file
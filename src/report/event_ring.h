@@ -0,0 +1,245 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace buried {
+
+// 环形队列写满时的处理策略
+enum class OverflowPolicy {
+  kDrop,                    // 丢弃新事件
+  kBlock,                   // 阻塞生产者直到有空位
+  kOverwriteLowestPriority  // 队首事件优先级更低时淘汰队首
+};
+
+// 有界无锁环形队列（Vyukov 算法），槽位预先分配。
+// 多个生产者无锁认领槽位，消费者（上报 strand）批量取出。
+// T 需要可默认构造、可移动，并带有 uint32_t 的 priority 成员。
+// 所有策略下队列都保持先进先出。
+template <typename T>
+class EventRing {
+ public:
+  // capacity 会向上取整为 2 的幂
+  EventRing(size_t capacity, OverflowPolicy policy)
+      : policy_(policy) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_ = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  EventRing(const EventRing&) = delete;
+  EventRing& operator=(const EventRing&) = delete;
+
+  // 写入一个事件，按溢出策略处理写满的情况，返回 false 表示 item 被丢弃
+  bool Push(T&& item) {
+    if (TryPush(item)) {
+      return true;
+    }
+    switch (policy_) {
+      case OverflowPolicy::kBlock:
+        while (!TryPush(item)) {
+          std::this_thread::yield();
+        }
+        return true;
+      case OverflowPolicy::kOverwriteLowestPriority:
+        return PushEvicting(item);
+      case OverflowPolicy::kDrop:
+      default:
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+  }
+
+  // 批量写入 count 个事件，返回写入的数量。
+  // 空间足够时一次 CAS 认领全部槽位，事件在队列中保持连续；
+  // 空间不足时 kBlock 等待整批的空间，其他策略逐个按溢出策略写入
+  size_t PushBulk(T* items, size_t count) {
+    if (TryPushBulk(items, count)) {
+      return count;
+    }
+    if (policy_ == OverflowPolicy::kBlock && count <= Capacity()) {
+      while (!TryPushBulk(items, count)) {
+        std::this_thread::yield();
+      }
+      return count;
+    }
+    size_t pushed = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (Push(std::move(items[i]))) {
+        ++pushed;
+      }
+    }
+    return pushed;
+  }
+
+  // 取出一个事件，队列为空时返回 false
+  bool Pop(T& out) { return TryPop(out); }
+
+  // 最多取出 max_count 个事件追加到 out，返回取出的数量
+  size_t PopBatch(std::vector<T>& out, size_t max_count) {
+    size_t count = 0;
+    T item;
+    while (count < max_count && TryPop(item)) {
+      out.push_back(std::move(item));
+      ++count;
+    }
+    return count;
+  }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+  // 近似的当前元素个数
+  size_t Size() const {
+    size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+    return tail >= head ? tail - head : 0;
+  }
+
+  // 因队列写满被丢弃（或被淘汰）的事件总数
+  uint64_t DroppedCount() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // 写满时与其他生产者、消费者竞争队首的最多次数
+  static constexpr size_t kMaxEvictRetries = 64;
+
+  struct alignas(64) Slot {
+    std::atomic<size_t> sequence;
+    std::atomic<uint32_t> priority{0};  // value 的优先级，淘汰时不读取 value
+    T value;
+  };
+
+  // 尝试写入，成功时 item 被移走
+  bool TryPush(T& item) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = slots_[pos & mask_];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          slot.priority.store(item.priority, std::memory_order_relaxed);
+          slot.value = std::move(item);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // 已满
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // 以最后一个槽位是否空闲判断空间：它空闲说明之前的槽位都已被消费者认领，
+  // 认领成功后个别槽位可能还在被消费者释放，写入前短暂等待
+  bool TryPushBulk(T* items, size_t count) {
+    if (count == 0) {
+      return true;
+    }
+    if (count > Capacity()) {
+      return false;
+    }
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t last = pos + count - 1;
+      size_t seq = slots_[last & mask_].sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(last);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + count,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // 空间不足
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    for (size_t i = 0; i < count; ++i) {
+      Slot& slot = slots_[(pos + i) & mask_];
+      while (slot.sequence.load(std::memory_order_acquire) != pos + i) {
+        std::this_thread::yield();
+      }
+      slot.priority.store(items[i].priority, std::memory_order_relaxed);
+      slot.value = std::move(items[i]);
+      slot.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    return true;
+  }
+
+  bool TryPop(T& out) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = slots_[pos & mask_];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          out = std::move(slot.value);
+          slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // 为空
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // 写满时只看队首：队首事件的优先级低于 item 时把它淘汰并写入 item，
+  // 否则丢弃 item。只认领队首一个槽位，不会打乱其他事件的顺序。
+  // 慢路径，只在队列写满时进入
+  bool PushEvicting(T& item) {
+    for (size_t i = 0; i < kMaxEvictRetries; ++i) {
+      size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+      Slot& slot = slots_[pos & mask_];
+      if (slot.sequence.load(std::memory_order_acquire) == pos + 1) {
+        if (slot.priority.load(std::memory_order_relaxed) >= item.priority) {
+          break;
+        }
+        // 认领成功说明读到的优先级属于当前队首
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          T victim = std::move(slot.value);
+          slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      // 空出的槽位可能被其他生产者抢走，此时重新检查队首
+      if (TryPush(item)) {
+        return true;
+      }
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+ private:
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  OverflowPolicy policy_;
+
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+  alignas(64) std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace buried
\ No newline at end of file
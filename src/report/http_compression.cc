@@ -0,0 +1,199 @@
+#include "report/http_compression.h"
+
+#include <algorithm>
+
+#include "boost/beast/zlib/deflate_stream.hpp"
+#include "boost/crc.hpp"
+
+namespace zlib = boost::beast::zlib;
+
+namespace buried {
+
+// 每次扩充输出缓冲区的最小字节数
+static constexpr size_t kOutputStep = 4096;
+
+// 把 value 按小端序追加到 out
+static void AppendLE32(std::string& out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+// 把 value 按大端序追加到 out
+static void AppendBE32(std::string& out, uint32_t value) {
+  for (int i = 3; i >= 0; --i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+// zlib 格式尾部使用的 Adler-32 校验和，在 adler 的基础上继续累加
+static uint32_t Adler32(uint32_t adler, const char* data, size_t size) {
+  // 65521 是小于 2^16 的最大素数，每 5552 字节取一次模不会溢出
+  constexpr uint32_t kBase = 65521;
+  constexpr size_t kMaxBlock = 5552;
+  uint32_t a = adler & 0xffff;
+  uint32_t b = adler >> 16;
+  size_t pos = 0;
+  while (pos < size) {
+    size_t end = std::min(size, pos + kMaxBlock);
+    for (; pos < end; ++pos) {
+      a += static_cast<uint8_t>(data[pos]);
+      b += a;
+    }
+    a %= kBase;
+    b %= kBase;
+  }
+  return (b << 16) | a;
+}
+
+class BodyCompressor::Impl {
+ public:
+  explicit Impl(const HttpCompression& compression)
+      : compression_(compression) {
+    Reset();
+  }
+
+  bool Write(const char* data, size_t size, std::string& out) {
+    if (compression_.encoding == HttpEncoding::kIdentity) {
+      out.append(data, size);
+      return true;
+    }
+    AppendHeader_(out);
+    if (compression_.encoding == HttpEncoding::kGzip) {
+      crc_.process_bytes(data, size);
+    } else {
+      adler_ = Adler32(adler_, data, size);
+    }
+    total_in_ += size;
+    return Deflate_(data, size, zlib::Flush::none, out);
+  }
+
+  bool Finish(std::string& out) {
+    if (compression_.encoding == HttpEncoding::kIdentity) {
+      return true;
+    }
+    AppendHeader_(out);
+    if (!Deflate_(nullptr, 0, zlib::Flush::finish, out)) {
+      return false;
+    }
+    if (compression_.encoding == HttpEncoding::kGzip) {
+      AppendLE32(out, crc_.checksum());
+      AppendLE32(out, static_cast<uint32_t>(total_in_));
+    } else {
+      AppendBE32(out, adler_);
+    }
+    return true;
+  }
+
+  void Reset() {
+    stream_.reset(std::clamp(compression_.level, 1, 9), 15, 8,
+                  zlib::Strategy::normal);
+    crc_.reset();
+    adler_ = 1;
+    total_in_ = 0;
+    header_written_ = false;
+  }
+
+ private:
+  void AppendHeader_(std::string& out) {
+    if (header_written_) {
+      return;
+    }
+    header_written_ = true;
+    if (compression_.encoding == HttpEncoding::kGzip) {
+      // 10 字节头：魔数、CM=8(deflate)、无标志、无时间戳、XFL=0、OS=255(未知)
+      static const char kGzipHeader[] = {'\x1f', '\x8b', '\x08', '\x00',
+                                         '\x00', '\x00', '\x00', '\x00',
+                                         '\x00', '\xff'};
+      out.append(kGzipHeader, sizeof(kGzipHeader));
+    } else {
+      // zlib 头：CMF=0x78(deflate, 32K 窗口)，FLG=0x9c 使头部能被 31 整除
+      out.push_back('\x78');
+      out.push_back('\x9c');
+    }
+  }
+
+  // 原始 deflate 数据追加到 out，输出空间不够时逐步扩充
+  bool Deflate_(const char* data, size_t size, zlib::Flush flush,
+                std::string& out) {
+    zlib::z_params params;
+    params.next_in = data;
+    params.avail_in = size;
+    for (;;) {
+      size_t offset = out.size();
+      size_t room = std::max(kOutputStep, stream_.upper_bound(params.avail_in));
+      out.resize(offset + room);
+      params.next_out = &out[offset];
+      params.avail_out = room;
+
+      boost::system::error_code ec;
+      stream_.write(params, flush, ec);
+      out.resize(out.size() - params.avail_out);
+      if (ec == zlib::error::end_of_stream) {
+        return true;
+      }
+      if (ec == zlib::error::need_buffers) {
+        // 没有输入也没有待输出的数据
+        return flush != zlib::Flush::finish;
+      }
+      if (ec) {
+        return false;
+      }
+      if (flush != zlib::Flush::finish && params.avail_in == 0 &&
+          params.avail_out > 0) {
+        return true;
+      }
+    }
+  }
+
+ private:
+  HttpCompression compression_;
+  zlib::deflate_stream stream_;
+  boost::crc_32_type crc_;
+  uint32_t adler_ = 1;
+  uint64_t total_in_ = 0;
+  bool header_written_ = false;
+};
+
+BodyCompressor::BodyCompressor(const HttpCompression& compression)
+    : impl_(std::make_unique<Impl>(compression)) {}
+
+BodyCompressor::~BodyCompressor() {}
+
+bool BodyCompressor::Write(const char* data, size_t size, std::string& out) {
+  return impl_->Write(data, size, out);
+}
+
+bool BodyCompressor::Finish(std::string& out) { return impl_->Finish(out); }
+
+void BodyCompressor::Reset() { impl_->Reset(); }
+
+const char* EncodingName(HttpEncoding encoding) {
+  switch (encoding) {
+    case HttpEncoding::kGzip:
+      return "gzip";
+    case HttpEncoding::kDeflate:
+      return "deflate";
+    case HttpEncoding::kIdentity:
+    default:
+      return "";
+  }
+}
+
+bool CompressBody(const HttpCompression& compression, const std::string& body,
+                  std::string& out) {
+  if (compression.encoding == HttpEncoding::kIdentity ||
+      body.size() < compression.min_size) {
+    return false;
+  }
+  out.clear();
+  out.reserve(body.size() / 2);
+  BodyCompressor compressor(compression);
+  if (!compressor.Write(body.data(), body.size(), out) ||
+      !compressor.Finish(out)) {
+    return false;
+  }
+  return out.size() < body.size();
+}
+
+}  // namespace buried
\ No newline at end of file
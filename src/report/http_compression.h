@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+namespace buried {
+
+// 请求体的 Content-Encoding
+enum class HttpEncoding {
+  kIdentity,  // 不压缩
+  kGzip,      // gzip（RFC 1952）
+  kDeflate    // HTTP 语义下的 deflate，即 zlib 格式（RFC 1950）
+};
+
+// 请求体压缩参数
+struct HttpCompression {
+  HttpEncoding encoding = HttpEncoding::kGzip;
+  size_t min_size = 1024;  // 小于该字节数的请求体不压缩
+  int level = 6;           // 压缩级别 1~9，越大压缩率越高、越慢
+};
+
+// 流式压缩器，请求体分段产生时使用。输出格式与 CompressBody 相同，
+// 但不检查 min_size 阈值，encoding 为 kIdentity 时原样输出
+class BodyCompressor {
+ public:
+  explicit BodyCompressor(const HttpCompression& compression);
+
+  ~BodyCompressor();
+
+  BodyCompressor(const BodyCompressor&) = delete;
+  BodyCompressor& operator=(const BodyCompressor&) = delete;
+
+  // 压缩一段输入，压缩结果追加到 out，失败返回 false
+  bool Write(const char* data, size_t size, std::string& out);
+
+  // 结束压缩，把剩余数据和校验尾部追加到 out，失败返回 false
+  bool Finish(std::string& out);
+
+  // 丢弃已有状态，重新开始一段新的输出
+  void Reset();
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+// Content-Encoding 头的取值，kIdentity 时返回空字符串
+const char* EncodingName(HttpEncoding encoding);
+
+// 按参数压缩 body 写入 out，返回 false 表示未压缩（未开启、
+// 低于阈值或压缩后没有变小），此时调用方应直接发送原始 body
+bool CompressBody(const HttpCompression& compression, const std::string& body,
+                  std::string& out);
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "report/http_connection_pool.h"
+
+#include <algorithm>
+
+namespace buried {
+
+using tcp = boost::asio::ip::tcp;
+
+HttpConnectionPool::HttpConnectionPool(boost::asio::io_context& ioc,
+                                       HttpPoolOptions options)
+    : ioc_(ioc), options_(options) {}
+
+HttpConnectionPool::~HttpConnectionPool() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& [key, connections] : idle_) {
+    for (auto& connection : connections) {
+      boost::system::error_code ec;
+      connection.stream->socket().shutdown(tcp::socket::shutdown_both, ec);
+    }
+  }
+}
+
+// 非阻塞地窥探一个字节：would_block 说明连接空闲且仍然可用，读到 EOF 或数据
+// 都说明连接已不可复用（服务端可能在 keep-alive 超时后已经关闭了连接）
+bool HttpConnectionPool::IsAlive(tcp::socket& socket) {
+  if (!socket.is_open()) {
+    return false;
+  }
+  boost::system::error_code ec;
+  socket.non_blocking(true, ec);
+  if (ec) {
+    return false;
+  }
+  char byte;
+  socket.receive(boost::asio::buffer(&byte, 1), tcp::socket::message_peek,
+                 ec);
+  bool alive = ec == boost::asio::error::would_block;
+  socket.non_blocking(false, ec);
+  return alive && !ec;
+}
+
+// 从最近归还的连接开始取，跳过已过期或已被对端关闭的连接
+std::unique_ptr<HttpConnectionPool::Stream> HttpConnectionPool::AcquireIdle(
+    const std::string& host, const std::string& port) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = idle_.find(Key(host, port));
+  if (iter == idle_.end()) {
+    return nullptr;
+  }
+  auto& connections = iter->second;
+  auto now = Clock::now();
+  while (!connections.empty()) {
+    IdleConnection connection = std::move(connections.back());
+    connections.pop_back();
+    if (now < connection.expires_at && IsAlive(connection.stream->socket())) {
+      return std::move(connection.stream);
+    }
+    boost::system::error_code ec;
+    connection.stream->socket().shutdown(tcp::socket::shutdown_both, ec);
+  }
+  return nullptr;
+}
+
+std::unique_ptr<HttpConnectionPool::Stream> HttpConnectionPool::Connect(
+    const std::string& host, const std::string& port) {
+  auto stream = std::make_unique<Stream>(ioc_);
+  boost::system::error_code ec;
+  stream->connect(Resolve(host, port), ec);
+  if (ec) {
+    // 地址可能已经变化，清掉缓存让下次重新解析
+    InvalidateEndpoints(host, port);
+    throw boost::system::system_error{ec};
+  }
+  stream->socket().set_option(tcp::no_delay(true), ec);
+  return stream;
+}
+
+void HttpConnectionPool::Release(const std::string& host,
+                                 const std::string& port,
+                                 std::unique_ptr<Stream> stream,
+                                 std::chrono::seconds keep_alive) {
+  if (!stream || !stream->socket().is_open()) {
+    return;
+  }
+  // 比服务端声明的超时提前 1 秒淘汰，避免复用时恰好碰上服务端关闭连接
+  std::chrono::seconds idle_timeout = options_.idle_timeout;
+  if (keep_alive.count() > 0) {
+    idle_timeout = std::min(idle_timeout, keep_alive - std::chrono::seconds(1));
+  }
+  if (idle_timeout.count() <= 0) {
+    boost::system::error_code ec;
+    stream->socket().shutdown(tcp::socket::shutdown_both, ec);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& connections = idle_[Key(host, port)];
+  if (connections.size() >= options_.max_idle_per_host) {
+    boost::system::error_code ec;
+    stream->socket().shutdown(tcp::socket::shutdown_both, ec);
+    return;
+  }
+  connections.push_back(
+      IdleConnection{std::move(stream), Clock::now() + idle_timeout});
+}
+
+HttpConnectionPool::Endpoints HttpConnectionPool::Resolve(
+    const std::string& host, const std::string& port) {
+  Endpoints endpoints;
+  if (CachedEndpoints(host, port, endpoints)) {
+    return endpoints;
+  }
+  tcp::resolver resolver(ioc_);
+  endpoints = resolver.resolve(host, port);
+  StoreEndpoints(host, port, endpoints);
+  return endpoints;
+}
+
+bool HttpConnectionPool::CachedEndpoints(const std::string& host,
+                                         const std::string& port,
+                                         Endpoints& endpoints) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = resolve_cache_.find(Key(host, port));
+  if (iter == resolve_cache_.end() || iter->second.expires_at < Clock::now()) {
+    return false;
+  }
+  endpoints = iter->second.endpoints;
+  return true;
+}
+
+void HttpConnectionPool::StoreEndpoints(const std::string& host,
+                                        const std::string& port,
+                                        const Endpoints& endpoints) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  resolve_cache_[Key(host, port)] =
+      ResolveEntry{endpoints, Clock::now() + options_.resolve_ttl};
+}
+
+void HttpConnectionPool::InvalidateEndpoints(const std::string& host,
+                                             const std::string& port) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  resolve_cache_.erase(Key(host, port));
+}
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/beast/core/tcp_stream.hpp"
+
+namespace buried {
+
+// 连接池参数
+struct HttpPoolOptions {
+  size_t max_idle_per_host = 4;           // 每个 host:port 最多保留的空闲连接
+  std::chrono::seconds idle_timeout{30};  // 空闲超过该时长的连接不再复用
+  std::chrono::seconds resolve_ttl{300};  // DNS 解析结果的缓存时长
+};
+
+// HTTP/1.1 长连接池，按 host:port 缓存空闲连接和 DNS 解析结果。
+// 线程安全，取出的连接在归还之前只由调用方使用
+class HttpConnectionPool {
+ public:
+  using Stream = boost::beast::tcp_stream;
+  using Endpoints = boost::asio::ip::tcp::resolver::results_type;
+
+ public:
+  explicit HttpConnectionPool(boost::asio::io_context& ioc,
+                              HttpPoolOptions options = HttpPoolOptions());
+
+  ~HttpConnectionPool();
+
+  HttpConnectionPool(const HttpConnectionPool&) = delete;
+  HttpConnectionPool& operator=(const HttpConnectionPool&) = delete;
+
+  // 取出一条空闲连接，没有可用连接时返回 nullptr
+  std::unique_ptr<Stream> AcquireIdle(const std::string& host,
+                                      const std::string& port);
+
+  // 新建一条连接，解析结果优先使用缓存，失败时抛出 boost::system::system_error
+  std::unique_ptr<Stream> Connect(const std::string& host,
+                                  const std::string& port);
+
+  // 归还一条仍可复用（服务端同意 keep-alive）的连接，keep_alive 为服务端
+  // 在 Keep-Alive 头中声明的空闲超时，为 0 时只按 idle_timeout 淘汰
+  void Release(const std::string& host, const std::string& port,
+               std::unique_ptr<Stream> stream,
+               std::chrono::seconds keep_alive = std::chrono::seconds(0));
+
+  // 同步解析 host:port，命中未过期的缓存时直接返回
+  Endpoints Resolve(const std::string& host, const std::string& port);
+
+  // 查询未过期的解析缓存，不存在时返回 false
+  bool CachedEndpoints(const std::string& host, const std::string& port,
+                       Endpoints& endpoints);
+
+  // 写入解析缓存
+  void StoreEndpoints(const std::string& host, const std::string& port,
+                      const Endpoints& endpoints);
+
+  // 连接失败时清除解析缓存，下一次重新解析
+  void InvalidateEndpoints(const std::string& host, const std::string& port);
+
+  boost::asio::io_context& GetIOContext() { return ioc_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct IdleConnection {
+    std::unique_ptr<Stream> stream;
+    Clock::time_point expires_at;
+  };
+
+  struct ResolveEntry {
+    Endpoints endpoints;
+    Clock::time_point expires_at;
+  };
+
+  // 对端已关闭或发来了意外数据的连接不能再复用
+  static bool IsAlive(boost::asio::ip::tcp::socket& socket);
+
+  static std::string Key(const std::string& host, const std::string& port) {
+    return host + ":" + port;
+  }
+
+ private:
+  boost::asio::io_context& ioc_;
+  HttpPoolOptions options_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<IdleConnection>> idle_;
+  std::unordered_map<std::string, ResolveEntry> resolve_cache_;
+};
+
+}  // namespace buried
\ No newline at end of file
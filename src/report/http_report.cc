@@ -1,11 +1,19 @@
 #include "report/http_report.h"
 
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
 #include "boost/asio/connect.hpp"
 #include "boost/asio/io_context.hpp"
 #include "boost/asio/ip/tcp.hpp"
+#include "boost/asio/post.hpp"
+#include "boost/asio/steady_timer.hpp"
+#include "boost/asio/write.hpp"
 #include "boost/beast/core.hpp"
 #include "boost/beast/http.hpp"
 #include "boost/beast/version.hpp"
+#include "report/http_connection_pool.h"
 #include "spdlog/spdlog.h"
 
 // 命名空间别名，方便后续代码书写
@@ -19,52 +27,507 @@ namespace buried {
 // 全局 io_context 对象，用于所有 I/O 操作
 static boost::asio::io_context ioc;
 
+using HttpHeaders = std::vector<std::pair<std::string, std::string>>;
+
+// 构造 HTTP POST 请求，请求体达到压缩阈值时压缩并设置 Content-Encoding，
+// 有请求体变换时对压缩后的结果整体变换
+static http::request<http::string_body> MakeRequest(
+    const std::string& host, const std::string& topic, const std::string& body,
+    const HttpCompression& compression, bool keep_alive,
+    HttpBodyFilter* filter, const HttpHeaders& headers) {
+  int version = 11;  // HTTP 1.1
+  http::request<http::string_body> req{http::verb::post, topic, version};
+  req.set(http::field::host, host);
+  req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+  req.set(http::field::content_type, "application/json");
+  for (const auto& [name, value] : headers) {
+    req.set(name, value);
+  }
+  req.keep_alive(keep_alive);
+  if (CompressBody(compression, body, req.body())) {
+    req.set(http::field::content_encoding,
+            EncodingName(compression.encoding));
+  } else {
+    req.body() = body;
+  }
+  if (filter) {
+    std::string filtered;
+    if (!filter->Begin(filtered) ||
+        !filter->Update(req.body().data(), req.body().size(), filtered) ||
+        !filter->Finish(filtered)) {
+      throw std::runtime_error("filter body failed");
+    }
+    req.body() = std::move(filtered);
+  }
+  req.prepare_payload();
+  return req;
+}
+
+// 构造流式上报的请求头，请求体使用 chunked 编码。
+// Content-Encoding 在读到第一段请求体后由 HttpSession 决定
+static http::request<http::empty_body> MakeStreamHeader(
+    const std::string& host, const std::string& topic,
+    const HttpHeaders& headers) {
+  http::request<http::empty_body> req{http::verb::post, topic, 11};
+  req.set(http::field::host, host);
+  req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+  req.set(http::field::content_type, "application/json");
+  for (const auto& [name, value] : headers) {
+    req.set(name, value);
+  }
+  req.keep_alive(true);
+  req.chunked(true);
+  return req;
+}
+
+// 复用的连接在返回任何响应数据之前就被对端关闭，说明服务端没有处理这次请求，
+// 可以换新连接重发；超时等其他读错误时请求可能已被处理，重发会产生重复事件
+static bool ClosedBeforeResponse(const beast::error_code& ec, size_t bytes,
+                                 const beast::flat_buffer& buffer) {
+  if (bytes > 0 || buffer.size() > 0) {
+    return false;
+  }
+  return ec == http::error::end_of_stream || ec == net::error::eof ||
+         ec == net::error::connection_reset ||
+         ec == net::error::connection_aborted;
+}
+
+// 解析响应的 Keep-Alive: timeout=N，没有声明时返回 0
+template <class Body>
+static std::chrono::seconds KeepAliveTimeout(
+    const http::response<Body>& res) {
+  auto iter = res.find(http::field::keep_alive);
+  if (iter == res.end()) {
+    return std::chrono::seconds(0);
+  }
+  std::string value(iter->value());
+  auto pos = value.find("timeout=");
+  if (pos == std::string::npos) {
+    return std::chrono::seconds(0);
+  }
+  return std::chrono::seconds(std::atoi(value.c_str() + pos + 8));
+}
+
+// 一次异步上报：取连接 ->（解析 -> 连接）-> 写请求 -> 读响应。
+// 每个阶段单独设置超时，复用的空闲连接写失败，或读响应时连接在返回任何数据
+// 之前就被关闭，才换新连接重试一次。
+// 设置了流式请求体时，每发送完一段才产生下一段，内存占用只有一段的大小。
+// 启用压缩时第一段读到 min_size 或请求体结束后才决定是否压缩，之后再发送请求头
+class HttpSession : public std::enable_shared_from_this<HttpSession> {
+ public:
+  HttpSession(std::shared_ptr<spdlog::logger> logger,
+              std::shared_ptr<HttpConnectionPool> pool, std::string host,
+              std::string port, HttpTimeouts timeouts,
+              http::request<http::string_body> req,
+              std::function<void(bool)> callback)
+      : logger_(std::move(logger)),
+        pool_(std::move(pool)),
+        host_(std::move(host)),
+        port_(std::move(port)),
+        timeouts_(timeouts),
+        req_(std::move(req)),
+        callback_(std::move(callback)),
+        resolver_(pool_->GetIOContext()),
+        resolve_timer_(pool_->GetIOContext()) {}
+
+  // 改为流式发送请求体，需要在 Start 之前调用
+  void StreamBody(http::request<http::empty_body> header,
+                  std::shared_ptr<HttpBodySource> source,
+                  net::io_context* read_context,
+                  const HttpCompression& compression,
+                  std::shared_ptr<HttpBodyFilter> filter) {
+    header_ = std::move(header);
+    source_ = std::move(source);
+    read_context_ = read_context;
+    compression_ = compression;
+    compressor_ = std::make_unique<BodyCompressor>(compression);
+    filter_ = std::move(filter);
+  }
+
+  void Start() {
+    stream_ = pool_->AcquireIdle(host_, port_);
+    reused_ = stream_ != nullptr;
+    if (reused_) {
+      Write_();
+      return;
+    }
+    Resolve_();
+  }
+
+ private:
+  void Resolve_() {
+    HttpConnectionPool::Endpoints endpoints;
+    if (pool_->CachedEndpoints(host_, port_, endpoints)) {
+      Connect_(endpoints);
+      return;
+    }
+    // resolver 没有自带超时，用定时器到期后取消解析
+    resolve_timer_.expires_after(timeouts_.resolve);
+    resolve_timer_.async_wait(
+        [self = shared_from_this()](const beast::error_code& ec) {
+          if (!ec) {
+            self->resolver_.cancel();
+          }
+        });
+    resolver_.async_resolve(
+        host_, port_,
+        [self = shared_from_this()](const beast::error_code& ec,
+                                    tcp::resolver::results_type results) {
+          self->resolve_timer_.cancel();
+          if (ec) {
+            self->Fail_("resolve", ec);
+            return;
+          }
+          self->pool_->StoreEndpoints(self->host_, self->port_, results);
+          self->Connect_(results);
+        });
+  }
+
+  void Connect_(const HttpConnectionPool::Endpoints& endpoints) {
+    stream_ = std::make_unique<beast::tcp_stream>(pool_->GetIOContext());
+    stream_->expires_after(timeouts_.connect);
+    stream_->async_connect(
+        endpoints, [self = shared_from_this()](const beast::error_code& ec,
+                                               const tcp::endpoint&) {
+          if (ec) {
+            self->pool_->InvalidateEndpoints(self->host_, self->port_);
+            self->Fail_("connect", ec);
+            return;
+          }
+          beast::error_code option_ec;
+          self->stream_->socket().set_option(tcp::no_delay(true), option_ec);
+          self->Write_();
+        });
+  }
+
+  void Write_() {
+    if (source_) {
+      StartBody_();
+      return;
+    }
+    stream_->expires_after(timeouts_.write);
+    http::async_write(*stream_, req_,
+                      [self = shared_from_this()](const beast::error_code& ec,
+                                                  size_t) {
+                        if (ec) {
+                          self->RetryOrFail_("write", ec);
+                          return;
+                        }
+                        self->Read_();
+                      });
+  }
+
+  // 重试时请求体从头开始重新产生
+  void StartBody_() {
+    source_->Rewind();
+    compressor_->Reset();
+    filter_begun_ = false;
+    ProduceChunk_(true);
+  }
+
+  // 第一段请求体产生后才发送请求头，Content-Encoding 取决于第一段的大小
+  void WriteHeader_(std::string chunk, bool more) {
+    header_.erase(http::field::content_encoding);
+    if (compress_) {
+      header_.set(http::field::content_encoding,
+                  EncodingName(compression_.encoding));
+    }
+    serializer_ =
+        std::make_unique<http::request_serializer<http::empty_body>>(header_);
+    stream_->expires_after(timeouts_.write);
+    http::async_write_header(
+        *stream_, *serializer_,
+        [self = shared_from_this(), chunk = std::move(chunk), more](
+            const beast::error_code& ec, size_t) mutable {
+          if (ec) {
+            self->RetryOrFail_("write", ec);
+            return;
+          }
+          self->WriteChunk_(std::move(chunk), more);
+        });
+  }
+
+  // 产生、压缩并变换下一段请求体，完成后回到网络线程发送。
+  // 变换紧跟在压缩之后逐段进行，不需要先得到完整的请求体。
+  // first 时一直读到 min_size 或请求体结束，小于 min_size 的请求体不压缩
+  void ProduceChunk_(bool first = false) {
+    auto produce = [self = shared_from_this(), first]() {
+      std::string plain;
+      bool more = self->source_->Read(plain);
+      // 只有可能压缩时才预读到 min_size，不压缩时第一段和后续段一样大
+      const HttpCompression& compression = self->compression_;
+      if (first && compression.encoding != HttpEncoding::kIdentity) {
+        while (more && plain.size() < compression.min_size) {
+          std::string next;
+          more = self->source_->Read(next);
+          plain += next;
+        }
+        self->compress_ = plain.size() >= compression.min_size;
+      }
+      std::string chunk;
+      bool ok = true;
+      if (self->compress_) {
+        ok = self->compressor_->Write(plain.data(), plain.size(), chunk) &&
+             (more || self->compressor_->Finish(chunk));
+      } else {
+        chunk = std::move(plain);
+      }
+      if (ok && self->filter_) {
+        std::string filtered;
+        if (!self->filter_begun_) {
+          ok = self->filter_->Begin(filtered);
+          self->filter_begun_ = true;
+        }
+        ok = ok && self->filter_->Update(chunk.data(), chunk.size(),
+                                         filtered) &&
+             (more || self->filter_->Finish(filtered));
+        chunk = std::move(filtered);
+      }
+      net::post(self->pool_->GetIOContext(),
+                [self, ok, more, first, chunk = std::move(chunk)]() mutable {
+                  if (!ok) {
+                    self->Fail_("compress", beast::errc::make_error_code(
+                                                beast::errc::io_error));
+                    return;
+                  }
+                  if (first) {
+                    self->WriteHeader_(std::move(chunk), more);
+                    return;
+                  }
+                  self->WriteChunk_(std::move(chunk), more);
+                });
+    };
+    if (read_context_) {
+      net::post(*read_context_, std::move(produce));
+    } else {
+      produce();
+    }
+  }
+
+  // 空的分段不发送，否则会被对端当作结束标记
+  void WriteChunk_(std::string chunk, bool more) {
+    chunk_ = std::move(chunk);
+    if (chunk_.empty()) {
+      if (more) {
+        ProduceChunk_();
+      } else {
+        WriteLastChunk_();
+      }
+      return;
+    }
+    stream_->expires_after(timeouts_.write);
+    net::async_write(*stream_, http::make_chunk(net::buffer(chunk_)),
+                     [self = shared_from_this(), more](
+                         const beast::error_code& ec, size_t) {
+                       if (ec) {
+                         self->RetryOrFail_("write", ec);
+                         return;
+                       }
+                       if (more) {
+                         self->ProduceChunk_();
+                       } else {
+                         self->WriteLastChunk_();
+                       }
+                     });
+  }
+
+  void WriteLastChunk_() {
+    chunk_.clear();
+    stream_->expires_after(timeouts_.write);
+    net::async_write(*stream_, http::make_chunk_last(),
+                     [self = shared_from_this()](const beast::error_code& ec,
+                                                 size_t) {
+                       if (ec) {
+                         self->RetryOrFail_("write", ec);
+                         return;
+                       }
+                       self->Read_();
+                     });
+  }
+
+  void Read_() {
+    stream_->expires_after(timeouts_.read);
+    http::async_read(*stream_, buffer_, res_,
+                     [self = shared_from_this()](const beast::error_code& ec,
+                                                 size_t bytes) {
+                       if (ec) {
+                         if (ClosedBeforeResponse(ec, bytes, self->buffer_)) {
+                           self->RetryOrFail_("read", ec);
+                         } else {
+                           self->Fail_("read", ec);
+                         }
+                         return;
+                       }
+                       self->Done_();
+                     });
+  }
+
+  // 复用的连接可能已被服务端关闭，这种情况下只重试一次
+  void RetryOrFail_(const char* phase, const beast::error_code& ec) {
+    if (reused_ && !retried_) {
+      SPDLOG_LOGGER_TRACE(logger_, "stale connection, retry " + ec.message());
+      retried_ = true;
+      reused_ = false;
+      stream_.reset();
+      buffer_.clear();
+      res_ = {};
+      Resolve_();
+      return;
+    }
+    Fail_(phase, ec);
+  }
+
+  void Fail_(const char* phase, const beast::error_code& ec) {
+    SPDLOG_LOGGER_ERROR(logger_, "report error " + std::string(phase) + " " +
+                                     ec.message());
+    if (stream_) {
+      beast::error_code shutdown_ec;
+      stream_->socket().shutdown(tcp::socket::shutdown_both, shutdown_ec);
+    }
+    callback_(false);
+  }
+
+  void Done_() {
+    stream_->expires_never();
+    // 服务端同意保持连接时归还给连接池，否则关闭
+    if (res_.keep_alive()) {
+      pool_->Release(host_, port_, std::move(stream_), KeepAliveTimeout(res_));
+    } else {
+      beast::error_code ec;
+      stream_->socket().shutdown(tcp::socket::shutdown_both, ec);
+    }
+
+    if (res_.result() != http::status::ok) {
+      SPDLOG_LOGGER_ERROR(logger_,
+                          "report error " + std::to_string(res_.result_int()));
+      callback_(false);
+      return;
+    }
+    std::string res_body = boost::beast::buffers_to_string(res_.body().data());
+    SPDLOG_LOGGER_TRACE(logger_, "report success" + res_body);
+    callback_(true);
+  }
+
+ private:
+  std::shared_ptr<spdlog::logger> logger_;
+  std::shared_ptr<HttpConnectionPool> pool_;
+  std::string host_;
+  std::string port_;
+  HttpTimeouts timeouts_;
+  http::request<http::string_body> req_;
+  std::function<void(bool)> callback_;
+
+  tcp::resolver resolver_;
+  net::steady_timer resolve_timer_;
+  std::unique_ptr<beast::tcp_stream> stream_;
+  beast::flat_buffer buffer_;
+  http::response<http::dynamic_body> res_;
+
+  // 流式请求体
+  http::request<http::empty_body> header_;
+  std::unique_ptr<http::request_serializer<http::empty_body>> serializer_;
+  std::shared_ptr<HttpBodySource> source_;
+  net::io_context* read_context_ = nullptr;
+  HttpCompression compression_;
+  std::unique_ptr<BodyCompressor> compressor_;
+  bool compress_ = false;  // 当前请求体是否压缩，读到第一段后决定
+  std::shared_ptr<HttpBodyFilter> filter_;
+  bool filter_begun_ = false;  // 当前请求体是否已经调用过 filter_->Begin
+  std::string chunk_;  // 正在发送的一段
+
+  bool reused_ = false;   // 当前连接是否取自连接池
+  bool retried_ = false;  // 是否已经重试过
+};
+
+// 在一条已连接的流上发送请求并读取响应
+// 失败时返回能否换新连接重发，见 ClosedBeforeResponse
+static bool WriteAndRead(beast::tcp_stream& stream,
+                         const http::request<http::string_body>& req,
+                         http::response<http::dynamic_body>& res,
+                         beast::error_code& ec) {
+  http::write(stream, req, ec);
+  if (ec) {
+    return true;
+  }
+  // 用于读取响应的缓冲区
+  beast::flat_buffer buffer;
+  size_t bytes = http::read(stream, buffer, res, ec);
+  return ec && ClosedBeforeResponse(ec, bytes, buffer);
+}
+
 // 构造函数，初始化 logger_
 HttpReporter::HttpReporter(std::shared_ptr<spdlog::logger> logger)
     : logger_(logger) {}
 
 // 执行 HTTP 报告（发送 POST 请求），返回是否成功
 bool HttpReporter::Report() {
+  // 同步上报不需要控制内存，流式请求体直接拼成完整的请求体
+  if (body_source_) {
+    body_.clear();
+    body_source_->Rewind();
+    std::string chunk;
+    bool more = true;
+    while (more) {
+      chunk.clear();
+      more = body_source_->Read(chunk);
+      body_ += chunk;
+    }
+  }
   try {
-    int version = 11;  // HTTP 1.1
+    // 构造 HTTP POST 请求
+    auto req = MakeRequest(host_, topic_, body_, compression_,
+                           pool_ != nullptr, filter_.get(), headers_);
 
-    // 创建解析器和 TCP 流对象
-    tcp::resolver resolver(ioc);
-    beast::tcp_stream stream(ioc);
+    // 用于存放响应的对象
+    http::response<http::dynamic_body> res;
+    beast::error_code ec;
 
-    // 解析主机名和端口
-    boost::asio::ip::tcp::resolver::query query(host_, port_);
-    auto const results = resolver.resolve(query);
+    if (pool_) {
+      // 优先复用空闲连接，没有时新建
+      auto stream = pool_->AcquireIdle(host_, port_);
+      bool reused = stream != nullptr;
+      if (!reused) {
+        stream = pool_->Connect(host_, port_);
+      }
+      bool retryable = WriteAndRead(*stream, req, res, ec);
+      if (ec && reused && retryable) {
+        // 空闲连接可能已被服务端关闭，换一条新连接重试一次
+        SPDLOG_LOGGER_TRACE(logger_,
+                            "stale connection, retry " + ec.message());
+        res = {};
+        stream = pool_->Connect(host_, port_);
+        WriteAndRead(*stream, req, res, ec);
+      }
+      if (ec) throw beast::system_error{ec};
 
-    // 连接到解析得到的 IP 地址
-    stream.connect(results);
+      // 服务端同意保持连接时归还给连接池，否则关闭
+      if (res.keep_alive()) {
+        pool_->Release(host_, port_, std::move(stream), KeepAliveTimeout(res));
+      } else {
+        stream->socket().shutdown(tcp::socket::shutdown_both, ec);
+      }
+    } else {
+      // 创建解析器和 TCP 流对象
+      tcp::resolver resolver(ioc);
+      beast::tcp_stream stream(ioc);
 
-    // 构造 HTTP POST 请求
-    http::request<http::string_body> req{http::verb::post, topic_, version};
-    req.set(http::field::host, host_);
-    req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-    req.set(http::field::content_type, "application/json");
-    req.body() = body_;
-    req.prepare_payload();
+      // 解析主机名和端口
+      boost::asio::ip::tcp::resolver::query query(host_, port_);
+      auto const results = resolver.resolve(query);
 
-    // 发送 HTTP 请求
-    http::write(stream, req);
+      // 连接到解析得到的 IP 地址
+      stream.connect(results);
 
-    // 用于读取响应的缓冲区
-    beast::flat_buffer buffer;
+      // 发送请求并接收响应
+      WriteAndRead(stream, req, res, ec);
+      if (ec) throw beast::system_error{ec};
 
-    // 用于存放响应的对象
-    http::response<http::dynamic_body> res;
-
-    // 接收 HTTP 响应
-    http::read(stream, buffer, res);
+      // 优雅关闭 socket
+      stream.socket().shutdown(tcp::socket::shutdown_both, ec);
 
-    // 优雅关闭 socket
-    beast::error_code ec;
-    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
-
-    // 有些情况下会出现 not_connected 错误，可以忽略
-    if (ec && ec != beast::errc::not_connected) throw beast::system_error{ec};
+      // 有些情况下会出现 not_connected 错误，可以忽略
+      if (ec && ec != beast::errc::not_connected) throw beast::system_error{ec};
+    }
 
     // 检查响应状态码
     auto res_status = res.result();
@@ -86,4 +549,36 @@ bool HttpReporter::Report() {
   return true;
 }
 
+void HttpReporter::AsyncReport(std::function<void(bool)> callback) {
+  if (!pool_) {
+    SPDLOG_LOGGER_ERROR(logger_, "async report requires connection pool");
+    callback(false);
+    return;
+  }
+  std::shared_ptr<HttpSession> session;
+  if (body_source_) {
+    session = std::make_shared<HttpSession>(
+        logger_, pool_, host_, port_, timeouts_,
+        http::request<http::string_body>(), std::move(callback));
+    session->StreamBody(
+        MakeStreamHeader(host_, topic_, headers_), body_source_,
+        read_context_, compression_, filter_);
+  } else {
+    http::request<http::string_body> req;
+    try {
+      req = MakeRequest(host_, topic_, body_, compression_, true,
+                        filter_.get(), headers_);
+    } catch (std::exception const& e) {
+      SPDLOG_LOGGER_ERROR(logger_, "report error " + std::string(e.what()));
+      callback(false);
+      return;
+    }
+    session = std::make_shared<HttpSession>(logger_, pool_, host_, port_,
+                                            timeouts_, std::move(req),
+                                            std::move(callback));
+  }
+  // 会话从 io_context 线程开始执行，调用方线程不做任何阻塞 I/O
+  net::post(pool_->GetIOContext(), [session]() { session->Start(); });
+}
+
 }  // namespace buried
\ No newline at end of file
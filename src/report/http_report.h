@@ -2,16 +2,65 @@
 
 #include <stdint.h>
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "report/http_compression.h"
 
 // 声明 spdlog 日志库的 logger 类
 namespace spdlog {
 class logger;
 }
 
+namespace boost {
+namespace asio {
+class io_context;
+}
+}  // namespace boost
+
 namespace buried {
 
+class HttpConnectionPool;
+
+// 流式请求体的数据来源，按段产生请求体，整个请求体不需要同时放在内存中
+class HttpBodySource {
+ public:
+  virtual ~HttpBodySource() = default;
+
+  // 把下一段内容写入 chunk（调用前 chunk 为空），返回 false 表示这是最后一段
+  virtual bool Read(std::string& chunk) = 0;
+
+  // 回到开头重新产生请求体，连接失败重试时使用
+  virtual void Rewind() = 0;
+};
+
+// 请求体压缩之后的分段变换（例如整体加密），重新产生请求体时从 Begin 重新开始
+class HttpBodyFilter {
+ public:
+  virtual ~HttpBodyFilter() = default;
+
+  // 开始一个新的请求体，开头的数据追加到 out
+  virtual bool Begin(std::string& out) = 0;
+
+  // 变换一段数据，结果追加到 out
+  virtual bool Update(const char* data, size_t size, std::string& out) = 0;
+
+  // 结束请求体，剩余的数据追加到 out
+  virtual bool Finish(std::string& out) = 0;
+};
+
+// 异步上报各阶段的超时时间
+struct HttpTimeouts {
+  std::chrono::milliseconds resolve{5000};
+  std::chrono::milliseconds connect{5000};
+  std::chrono::milliseconds write{10000};
+  std::chrono::milliseconds read{10000};
+};
+
 // HttpReporter 用于构建和发送 HTTP 报告的类
 class HttpReporter {
  public:
@@ -42,16 +91,67 @@ class HttpReporter {
     return *this;
   }
 
+  // 设置流式请求体，设置后忽略 Body，异步上报使用 chunked 编码边产生边发送。
+  // read_context 不为空时 Read 和压缩在它上面执行，不占用网络线程
+  HttpReporter& BodySource(std::shared_ptr<HttpBodySource> source,
+                           boost::asio::io_context* read_context = nullptr) {
+    body_source_ = std::move(source);
+    read_context_ = read_context;
+    return *this;
+  }
+
+  // 设置长连接池，设置后复用 keep-alive 连接，不设置则每次新建连接
+  HttpReporter& Pool(std::shared_ptr<HttpConnectionPool> pool) {
+    pool_ = std::move(pool);
+    return *this;
+  }
+
+  // 设置异步上报各阶段的超时时间
+  HttpReporter& Timeouts(const HttpTimeouts& timeouts) {
+    timeouts_ = timeouts;
+    return *this;
+  }
+
+  // 设置请求体压缩参数，默认不压缩
+  HttpReporter& Compression(const HttpCompression& compression) {
+    compression_ = compression;
+    return *this;
+  }
+
+  // 设置请求体变换，在压缩之后执行，同一时刻只能用于一个请求
+  HttpReporter& Filter(std::shared_ptr<HttpBodyFilter> filter) {
+    filter_ = std::move(filter);
+    return *this;
+  }
+
+  // 追加一个请求头，例如说明请求体变换方式的自定义头
+  HttpReporter& Header(const std::string& name, const std::string& value) {
+    headers_.emplace_back(name, value);
+    return *this;
+  }
+
   // 执行 HTTP 报告（发送请求），返回是否成功
   bool Report();
 
+  // 异步执行 HTTP 报告，必须先设置连接池，I/O 运行在连接池的 io_context 上。
+  // 完成后在该 io_context 的线程上回调 callback(是否成功)，
+  // 调用返回后 HttpReporter 本身可以立即销毁
+  void AsyncReport(std::function<void(bool)> callback);
+
  private:
   std::string host_;   // 服务器地址
   std::string topic_;  // 路径或主题
   std::string port_;   // 端口号
   std::string body_;   // 请求体内容
+  std::shared_ptr<HttpBodySource> body_source_;  // 流式请求体，可为空
+  boost::asio::io_context* read_context_ = nullptr;  // 产生流式请求体的线程
 
   std::shared_ptr<spdlog::logger> logger_; // 日志器
+  std::shared_ptr<HttpConnectionPool> pool_; // 长连接池，可为空
+  HttpTimeouts timeouts_;                    // 异步上报超时时间
+  HttpCompression compression_{HttpEncoding::kIdentity};  // 请求体压缩参数
+  std::shared_ptr<HttpBodyFilter> filter_;   // 压缩后的请求体变换，可为空
+  std::vector<std::pair<std::string, std::string>> headers_;  // 附加请求头
 };
 
 }  // namespace buried
\ No newline at end of file
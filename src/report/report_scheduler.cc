@@ -0,0 +1,54 @@
+#include "report/report_scheduler.h"
+
+#include <algorithm>
+
+namespace buried {
+
+ReportScheduler::ReportScheduler(const ReportSchedulerOptions& options)
+    : options_(options),
+      batch_rows_(options.min_batch_rows),
+      interval_(options.base_interval_ms),
+      rng_(std::random_device{}()) {}
+
+void ReportScheduler::OnCycle() { cycle_failed_ = false; }
+
+void ReportScheduler::OnSuccess(bool backlog) {
+  // 链路恢复后直接回到正常间隔，不从退避间隔逐步减半
+  if (failures_ > 0) {
+    failures_ = 0;
+    interval_ = std::chrono::milliseconds(options_.base_interval_ms);
+  }
+  if (backlog) {
+    batch_rows_ = std::min(options_.max_batch_rows, batch_rows_ * 2);
+    interval_ = std::max(std::chrono::milliseconds(options_.min_interval_ms),
+                         interval_ / 2);
+    return;
+  }
+  // 积压消化完后逐步回到正常的批次和间隔
+  batch_rows_ = std::max(options_.min_batch_rows, batch_rows_ / 2);
+  interval_ = std::min(std::chrono::milliseconds(options_.base_interval_ms),
+                       interval_ * 2);
+}
+
+void ReportScheduler::OnFailure() {
+  batch_rows_ = options_.min_batch_rows;
+  if (cycle_failed_) {
+    return;
+  }
+  cycle_failed_ = true;
+  ++failures_;
+  // base * 2^(failures - 1)，上限 max_backoff_ms
+  uint64_t backoff = options_.base_interval_ms;
+  for (uint32_t i = 1; i < failures_ && backoff < options_.max_backoff_ms;
+       ++i) {
+    backoff *= 2;
+  }
+  backoff = std::min<uint64_t>(backoff, options_.max_backoff_ms);
+  // 一半固定、一半随机，避免大量客户端在同一时刻重试，但不短于正常间隔
+  std::uniform_int_distribution<uint64_t> jitter(0, backoff / 2);
+  interval_ = std::chrono::milliseconds(
+      std::max<uint64_t>(options_.base_interval_ms,
+                         backoff - backoff / 2 + jitter(rng_)));
+}
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <random>
+
+namespace buried {
+
+// 自适应上报参数
+struct ReportSchedulerOptions {
+  int32_t min_batch_rows = 10;          // 单批最少行数
+  int32_t max_batch_rows = 500;         // 单批最多行数
+  size_t max_batch_bytes = 512 * 1024;  // 单批最多字节数（按存储内容计算）
+  uint32_t min_interval_ms = 200;       // 积压时最短的上报间隔
+  uint32_t base_interval_ms = 5000;     // 正常情况下的上报间隔
+  uint32_t max_backoff_ms = 300000;     // 连续失败时退避的最长间隔
+};
+
+// 根据积压和上报结果调整批次大小和上报间隔：
+// 积压且上报成功时批次翻倍、间隔减半；上报失败时批次回到最小，
+// 间隔按失败次数指数退避并加入随机抖动，退避后第一次成功即回到正常间隔。
+// 非线程安全，只在上报 strand 上使用
+class ReportScheduler {
+ public:
+  explicit ReportScheduler(const ReportSchedulerOptions& options);
+
+  // 下一批查询的行数
+  int32_t BatchRows() const { return batch_rows_; }
+
+  // 单批最多字节数
+  size_t MaxBatchBytes() const { return options_.max_batch_bytes; }
+
+  // 距离下一次上报周期的间隔
+  std::chrono::milliseconds Interval() const { return interval_; }
+
+  // 开始一个新的上报周期
+  void OnCycle();
+
+  // 一个批次上报成功，backlog 表示取批次时数据库里还有更多数据
+  void OnSuccess(bool backlog);
+
+  // 一个批次上报失败，同一周期内窗口中的多个批次失败只退避一次
+  void OnFailure();
+
+ private:
+  ReportSchedulerOptions options_;
+  int32_t batch_rows_;
+  std::chrono::milliseconds interval_;
+  uint32_t failures_ = 0;       // 连续失败的周期数
+  bool cycle_failed_ = false;  // 本周期是否已经有批次失败
+  std::mt19937 rng_;
+};
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "report/row_codec.h"
+
+#include <charconv>
+
+#include "common/common_service.h"
+#include "report/event_builder.h"
+#include "report/string_dictionary.h"
+
+namespace buried {
+
+// varint 最多 10 个字节
+static constexpr size_t kMaxVarintBytes = 10;
+
+static uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static void PutBytes(std::string& out, std::string_view value) {
+  PutVarint(out, value.size());
+  out.append(value.data(), value.size());
+}
+
+static bool GetBytes(std::string_view& in, std::string_view& value) {
+  uint64_t size = 0;
+  if (!GetVarint(in, size) || size > in.size()) {
+    return false;
+  }
+  value = in.substr(0, size);
+  in.remove_prefix(size);
+  return true;
+}
+
+static void PutStringRef(std::string& out, uint32_t id,
+                         std::string_view value) {
+  PutVarint(out, id);
+  if (id == 0) {
+    PutBytes(out, value);
+  }
+}
+
+static bool GetStringRef(std::string_view& in,
+                         const StringDictionary* dictionary, uint32_t& id,
+                         std::string_view& value) {
+  uint64_t ref = 0;
+  if (!GetVarint(in, ref) || ref > UINT32_MAX) {
+    return false;
+  }
+  id = static_cast<uint32_t>(ref);
+  if (id == 0) {
+    return GetBytes(in, value);
+  }
+  return dictionary != nullptr && dictionary->Lookup(id, value);
+}
+
+void PutVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>(value | 0x80);
+    value >>= 7;
+  }
+  out += static_cast<char>(value);
+}
+
+bool GetVarint(std::string_view& in, uint64_t& value) {
+  value = 0;
+  for (size_t i = 0; i < in.size() && i < kMaxVarintBytes; ++i) {
+    uint8_t byte = static_cast<uint8_t>(in[i]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      in.remove_prefix(i + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void EncodeRow(const RowEvent& event, int64_t base_timestamp,
+               std::string& out) {
+  out.reserve(out.size() + event.title.size() + event.data.size() +
+              event.process_time.size() + event.report_id.size() + 24);
+  out += static_cast<char>(kRowFormatV1);
+  PutVarint(out, event.flags);
+  PutStringRef(out, event.title_id, event.title);
+  PutBytes(out, event.data);
+  PutVarint(out, event.priority);
+  PutVarint(out, ZigZagEncode(event.timestamp - base_timestamp));
+  PutStringRef(out, event.process_time_id, event.process_time);
+  PutBytes(out, event.report_id);
+}
+
+bool DecodeRow(std::string_view row, int64_t base_timestamp, RowEvent& event,
+               const StringDictionary* dictionary) {
+  if (row.empty() || static_cast<uint8_t>(row.front()) != kRowFormatV1) {
+    return false;
+  }
+  row.remove_prefix(1);
+  uint64_t priority = 0;
+  uint64_t delta = 0;
+  if (!GetVarint(row, event.flags) ||
+      !GetStringRef(row, dictionary, event.title_id, event.title) ||
+      !GetBytes(row, event.data) || !GetVarint(row, priority) ||
+      !GetVarint(row, delta) ||
+      !GetStringRef(row, dictionary, event.process_time_id,
+                    event.process_time) ||
+      !GetBytes(row, event.report_id)) {
+    return false;
+  }
+  event.priority = static_cast<uint32_t>(priority);
+  event.timestamp = base_timestamp + ZigZagDecode(delta);
+  return true;
+}
+
+bool RowJsonWriter::Append(std::string_view row, int64_t base_timestamp,
+                           std::string& out) {
+  if (IsJsonRow(row)) {
+    out.append(row.data(), row.size());
+    return true;
+  }
+  RowEvent event;
+  if (!DecodeRow(row, base_timestamp, event, dictionary_)) {
+    return false;
+  }
+  int64_t second = event.timestamp / 1000;
+  if (second != date_second_) {
+    date_ = CommonService::GetDate(event.timestamp);
+    date_second_ = second;
+  }
+
+  out += '{';
+  AppendString_(out, "title", event.title_id, event.title);
+  out += ",\"data\":";
+  if (event.flags & kRowDataIsJson) {
+    out.append(event.data.data(), event.data.size());
+  } else {
+    AppendJsonString(out, event.data);
+  }
+  out += ",\"priority\":";
+  char buffer[16];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), event.priority);
+  out.append(buffer, result.ptr);
+  out += ",\"timestamp\":";
+  AppendJsonString(out, date_);
+  out += ',';
+  AppendString_(out, "process_time", event.process_time_id,
+                event.process_time);
+  out += ",\"report_id\":";
+  AppendJsonString(out, event.report_id);
+  out += '}';
+  return true;
+}
+
+void RowJsonWriter::AppendStrings(std::string& out) const {
+  out += '{';
+  bool first = true;
+  for (uint32_t id : used_ids_) {
+    std::string_view value;
+    if (!dictionary_->Lookup(id, value)) {
+      continue;
+    }
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    out += '"';
+    out += std::to_string(id);
+    out += "\":";
+    AppendJsonString(out, value);
+  }
+  out += '}';
+}
+
+void RowJsonWriter::AppendString_(std::string& out, std::string_view key,
+                                  uint32_t id, std::string_view value) {
+  out += '"';
+  out.append(key.data(), key.size());
+  if (wire_ids_ && id != 0) {
+    used_ids_.insert(id);
+    out += "_id\":";
+    out += std::to_string(id);
+    return;
+  }
+  out += "\":";
+  AppendJsonString(out, value);
+}
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace buried {
+
+class StringDictionary;
+
+// 数据库中事件内容（加密前）的紧凑二进制格式。
+// 第一个字节是格式版本，旧版本存储的 JSON 以 '{' 开头，两种行可以共存。
+// 版本 1 在版本字节之后依次为：
+//   flags         varint
+//   title         字符串引用
+//   data          varint 长度 + 字节
+//   priority      varint
+//   timestamp     zigzag varint，相对所在行 timestamp 列的毫秒差
+//   process_time  字符串引用
+//   report_id     varint 长度 + 字节
+// 字符串引用是一个 varint：0 表示后面紧跟 varint 长度 + 字节，
+// 大于 0 的值是 StringDictionary 中的 id
+inline constexpr uint8_t kRowFormatV1 = 0x01;
+
+// flags：data 已经是 JSON 对象，转换时原样嵌入
+inline constexpr uint64_t kRowDataIsJson = 1;
+
+// 一行事件的各个字段，字符串指向编码前的数据、解码时的输入或字典。
+// 编码时 id 不为 0 的字符串只写 id
+struct RowEvent {
+  uint64_t flags = 0;
+  uint32_t title_id = 0;
+  uint32_t process_time_id = 0;
+  std::string_view title;
+  std::string_view data;
+  uint32_t priority = 0;
+  int64_t timestamp = 0;  // 事件时间，毫秒
+  std::string_view process_time;
+  std::string_view report_id;
+};
+
+// 以 LEB128 格式追加一个无符号整数
+void PutVarint(std::string& out, uint64_t value);
+
+// 从 in 的开头读取一个 varint 并跳过它，数据截断或超长时返回 false
+bool GetVarint(std::string_view& in, uint64_t& value);
+
+// 编码一行追加到 out，base_timestamp 为所在行的 timestamp 列
+void EncodeRow(const RowEvent& event, int64_t base_timestamp,
+               std::string& out);
+
+// 解码一行，event 中的字符串指向 row 或 dictionary。
+// 版本不对、数据截断或引用了字典中没有的 id 时返回 false
+bool DecodeRow(std::string_view row, int64_t base_timestamp, RowEvent& event,
+               const StringDictionary* dictionary = nullptr);
+
+// 旧版本存储的行是 JSON 对象
+inline bool IsJsonRow(std::string_view row) {
+  return !row.empty() && row.front() == '{';
+}
+
+// 把数据库中的一行转换为上报用的 JSON 对象追加到 out：
+// 二进制行按字段生成 JSON，旧的 JSON 行原样拼接。
+// wire_ids 为 true 时字典中的字符串写为 "title_id"、"process_time_id"，
+// 由 AppendStrings 在批次中附带用到的条目。
+// 缓存最近一次格式化的时间，同一秒内的事件不重复格式化。非线程安全
+class RowJsonWriter {
+ public:
+  explicit RowJsonWriter(const StringDictionary* dictionary = nullptr,
+                         bool wire_ids = false)
+      : dictionary_(dictionary), wire_ids_(wire_ids) {}
+
+  // 无法解码时 out 保持不变并返回 false
+  bool Append(std::string_view row, int64_t base_timestamp, std::string& out);
+
+  // 把用到的字典条目写成 {"id":"字符串",...} 追加到 out
+  void AppendStrings(std::string& out) const;
+
+  // 清空用到的字典条目，重新生成同一批次时调用
+  void Reset() { used_ids_.clear(); }
+
+ private:
+  void AppendString_(std::string& out, std::string_view key, uint32_t id,
+                     std::string_view value);
+
+ private:
+  const StringDictionary* dictionary_;
+  bool wire_ids_;
+  std::set<uint32_t> used_ids_;
+
+  int64_t date_second_ = -1;
+  std::string date_;
+};
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "report/string_dictionary.h"
+
+#include <mutex>
+
+namespace buried {
+
+StringDictionary::StringDictionary(size_t max_entries)
+    : max_entries_(max_entries) {}
+
+// 数据库中的 id 可能不连续（例如上次退出前只保存了一部分），
+// 空位不分配给新字符串，查找时视为不存在
+void StringDictionary::Load(uint32_t id, std::string value) {
+  if (id == 0) {
+    return;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (values_.size() < id) {
+    values_.resize(id);
+    present_.resize(id, false);
+  }
+  std::string& slot = values_[id - 1];
+  if (present_[id - 1]) {
+    ids_.erase(slot);
+  }
+  present_[id - 1] = true;
+  slot = std::move(value);
+  ids_.emplace(slot, id);
+}
+
+// 引用这个 id 的事件无法解码，不能把 id 重新分配给别的字符串
+void StringDictionary::Reserve(uint32_t id) {
+  if (id == 0) {
+    return;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (values_.size() < id) {
+    values_.resize(id);
+    present_.resize(id, false);
+  }
+  if (present_[id - 1]) {
+    ids_.erase(values_[id - 1]);
+    present_[id - 1] = false;
+    values_[id - 1].clear();
+  }
+}
+
+uint32_t StringDictionary::Find(std::string_view value) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto iter = ids_.find(value);
+  return iter == ids_.end() ? 0 : iter->second;
+}
+
+// 先在读锁下查找，只有新字符串才加写锁
+uint32_t StringDictionary::Intern(std::string_view value) {
+  uint32_t id = Find(value);
+  if (id != 0) {
+    return id;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto iter = ids_.find(value);
+  if (iter != ids_.end()) {
+    return iter->second;
+  }
+  if (values_.size() >= max_entries_) {
+    return 0;
+  }
+  values_.emplace_back(value);
+  present_.push_back(true);
+  id = static_cast<uint32_t>(values_.size());
+  ids_.emplace(values_.back(), id);
+  unsaved_.push_back(id);
+  return id;
+}
+
+bool StringDictionary::Lookup(uint32_t id, std::string_view& value) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (id == 0 || id > values_.size() || !present_[id - 1]) {
+    return false;
+  }
+  value = values_[id - 1];
+  return true;
+}
+
+std::vector<std::pair<uint32_t, std::string>> StringDictionary::TakeUnsaved() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  std::vector<std::pair<uint32_t, std::string>> entries;
+  entries.reserve(unsaved_.size());
+  for (uint32_t id : unsaved_) {
+    entries.emplace_back(id, values_[id - 1]);
+  }
+  unsaved_.clear();
+  return entries;
+}
+
+size_t StringDictionary::Size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return values_.size();
+}
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace buried {
+
+// 字符串字典：把重复出现的字符串（事件标题等）映射为从 1 开始的 id，
+// 事件内容中只保存 id。条目只增不删，返回的 string_view 在字典销毁前有效。
+// 线程安全，查找只加读锁
+class StringDictionary {
+ public:
+  // 条目数上限，超过后不再分配新 id，调用方改为内联保存字符串
+  static constexpr size_t kDefaultMaxEntries = 4096;
+
+  explicit StringDictionary(size_t max_entries = kDefaultMaxEntries);
+
+  StringDictionary(const StringDictionary&) = delete;
+  StringDictionary& operator=(const StringDictionary&) = delete;
+
+  // 加入一个从数据库读出的条目，不计入未保存条目
+  void Load(uint32_t id, std::string value);
+
+  // 占住一个数据库中存在但无法读取的 id：查找时视为不存在，也不会分配给新字符串
+  void Reserve(uint32_t id);
+
+  // 查找已有的 id，不存在时返回 0
+  uint32_t Find(std::string_view value) const;
+
+  // 查找或分配 id，新分配的条目记为未保存。字典已满时返回 0
+  uint32_t Intern(std::string_view value);
+
+  // 按 id 取字符串，不存在（包括 Load 留下的空位）时返回 false
+  bool Lookup(uint32_t id, std::string_view& value) const;
+
+  // 取出自上次调用以来新分配的条目，调用方负责持久化
+  std::vector<std::pair<uint32_t, std::string>> TakeUnsaved();
+
+  size_t Size() const;
+
+ private:
+  size_t max_entries_;
+
+  mutable std::shared_mutex mutex_;
+  std::deque<std::string> values_;  // 下标为 id - 1，deque 追加时不移动已有元素
+  std::vector<bool> present_;       // values_ 对应位置是否有条目，空位为 false
+  std::unordered_map<std::string_view, uint32_t> ids_;  // 指向 values_ 中的字符串
+  std::vector<uint32_t> unsaved_;
+};
+
+}  // namespace buried
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mbedtls/cipher.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/gcm.h"
+#include "nlohmann/json.hpp"
+#include "src/crypt/crypt.h"
+
+// 加解密基准：密钥派生、不同负载大小上 CBC 和 GCM 的加解密、
+// 每次调用的固定开销和每次操作的堆分配次数。
+// 默认输出表格，--json 时输出 JSON，便于比较不同版本的结果
+
+namespace {
+
+// 全局 new 计数，用于统计每次操作的堆分配次数
+std::atomic<size_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 每项测量至少持续的时间
+constexpr auto kMinDuration = std::chrono::milliseconds(200);
+
+struct Result {
+  double ns_per_op = 0;
+  double mb_per_s = 0;
+  double allocs_per_op = 0;
+};
+
+// 重复执行 op 直到超过 kMinDuration，返回单次耗时、吞吐和堆分配次数
+template <typename F>
+Result Measure(size_t bytes, F&& op) {
+  op();  // 预热，排除第一次调用的初始化
+  size_t iterations = 0;
+  size_t allocations = g_allocations.load(std::memory_order_relaxed);
+  auto start = Clock::now();
+  auto elapsed = Clock::duration::zero();
+  do {
+    for (int i = 0; i < 16; ++i) {
+      op();
+    }
+    iterations += 16;
+    elapsed = Clock::now() - start;
+  } while (elapsed < kMinDuration);
+  allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+  double ns =
+      std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  return Result{ns, bytes / ns * 1e9 / (1024 * 1024),
+                static_cast<double>(allocations) / iterations};
+}
+
+const char* ModeName(buried::CipherMode mode) {
+  return mode == buried::CipherMode::kAesGcm ? "gcm" : "cbc";
+}
+
+class Report {
+ public:
+  explicit Report(bool json) : json_(json) {
+    if (!json_) {
+      printf("%-22s %-5s %8s %12s %10s %10s\n", "benchmark", "mode", "bytes",
+             "ns/op", "MB/s", "allocs/op");
+    }
+  }
+
+  void Add(const char* name, const char* mode, size_t bytes,
+           const Result& result) {
+    if (json_) {
+      results_.push_back({{"name", name},
+                          {"mode", mode},
+                          {"bytes", bytes},
+                          {"ns_per_op", result.ns_per_op},
+                          {"mb_per_s", result.mb_per_s},
+                          {"allocs_per_op", result.allocs_per_op}});
+      return;
+    }
+    printf("%-22s %-5s %8zu %12.0f %10.1f %10.2f\n", name, mode, bytes,
+           result.ns_per_op, result.mb_per_s, result.allocs_per_op);
+  }
+
+  void Print() {
+    if (json_) {
+      nlohmann::json output = {{"benchmarks", results_}};
+      printf("%s\n", output.dump(2).c_str());
+    }
+  }
+
+ private:
+  bool json_;
+  nlohmann::json results_ = nlohmann::json::array();
+};
+
+// AESCrypt 每次调用前设置初始向量并重置上下文
+Result MeasureCbcSetup(const std::string& key) {
+  mbedtls_cipher_context_t ctx;
+  mbedtls_cipher_init(&ctx);
+  mbedtls_cipher_setup(
+      &ctx, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_256_CBC));
+  mbedtls_cipher_setkey(
+      &ctx, reinterpret_cast<const unsigned char*>(key.data()),
+      static_cast<int>(key.size() * 8), MBEDTLS_ENCRYPT);
+  unsigned char iv[16] = {0};
+  Result result = Measure(0, [&]() {
+    mbedtls_cipher_set_iv(&ctx, iv, sizeof(iv));
+    mbedtls_cipher_reset(&ctx);
+  });
+  mbedtls_cipher_free(&ctx);
+  return result;
+}
+
+// AESGCMCrypt 每次调用生成 nonce 并开始一次 GCM 运算
+Result MeasureGcmSetup(const std::string& key) {
+  mbedtls_gcm_context gcm;
+  mbedtls_entropy_context entropy;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_gcm_init(&gcm);
+  mbedtls_entropy_init(&entropy);
+  mbedtls_ctr_drbg_init(&drbg);
+  mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, nullptr, 0);
+  mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES,
+                     reinterpret_cast<const unsigned char*>(key.data()),
+                     static_cast<unsigned int>(key.size() * 8));
+  unsigned char nonce[buried::AESGCMCrypt::kNonceSize];
+  Result result = Measure(0, [&]() {
+    mbedtls_ctr_drbg_random(&drbg, nonce, sizeof(nonce));
+    mbedtls_gcm_starts(&gcm, MBEDTLS_GCM_ENCRYPT, nonce, sizeof(nonce));
+  });
+  mbedtls_gcm_free(&gcm);
+  mbedtls_ctr_drbg_free(&drbg);
+  mbedtls_entropy_free(&entropy);
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool json = argc > 1 && strcmp(argv[1], "--json") == 0;
+  Report report(json);
+
+  std::string key;
+  report.Add("get_key", "", 0, Measure(0, [&]() {
+               key = buried::AESCrypt::GetKey("salt", "password");
+             }));
+  report.Add("setup", "cbc", 0, MeasureCbcSetup(key));
+  report.Add("setup", "gcm", 0, MeasureGcmSetup(key));
+
+  const std::vector<size_t> sizes = {100, 1024, 4096, 16 * 1024, 64 * 1024};
+  size_t sink = 0;
+  for (buried::CipherMode mode :
+       {buried::CipherMode::kAesCbc, buried::CipherMode::kAesGcm}) {
+    const char* name = ModeName(mode);
+    auto crypt = buried::CreateCrypt(mode, key);
+    for (size_t size : sizes) {
+      std::string input(size, 'x');
+      std::string encrypted = crypt->Encrypt(input);
+      report.Add("encrypt", name, size, Measure(size, [&]() {
+                   sink += crypt->Encrypt(input).size();
+                 }));
+      report.Add("decrypt", name, size, Measure(size, [&]() {
+                   sink += crypt->Decrypt(encrypted).size();
+                 }));
+
+      // 写入预先分配的缓冲区，不应有堆分配
+      std::vector<std::byte> buffer(crypt->EncryptedSize(size) +
+                                    crypt->DecryptedSize(encrypted.size()));
+      size_t written = 0;
+      report.Add("encrypt_into", name, size, Measure(size, [&]() {
+                   crypt->EncryptInto(std::as_bytes(std::span(input)), buffer,
+                                      written);
+                   sink += written;
+                 }));
+      report.Add("decrypt_into", name, size, Measure(size, [&]() {
+                   crypt->DecryptInto(std::as_bytes(std::span(encrypted)),
+                                      buffer, written);
+                   sink += written;
+                 }));
+    }
+  }
+  report.Print();
+  return sink == 0 ? 1 : 0;
+}
\ No newline at end of file
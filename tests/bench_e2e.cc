@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/beast/core.hpp"
+#include "boost/beast/http.hpp"
+#include "boost/beast/zlib/inflate_stream.hpp"
+#include "include/buried.h"
+#include "nlohmann/json.hpp"
+#include "src/third_party/sqlite/sqlite3.h"
+
+// 端到端基准：进程内启动一个回环地址上的收集端（server/src/main.rs 的替身），
+// 多个生产者线程按设定速率调用 Buried_Report，统计调用方延迟分布、
+// 持续写入速率、数据库积压的增长和上报吞吐。
+// 用法：buried_e2e_bench [--threads N] [--rate 每线程每秒事件数，0 为不限速]
+//       [--seconds 生产时长] [--drain 停止生产后等待上报的秒数]
+//       [--data-size 事件 data 字节数] [--work-dir 目录] [--json 结果文件]
+// 每个版本关注最后一行的 sustained_events_per_s：从开始生产到全部上报完成，
+// 端到端每秒送达收集端的事件数
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int threads = 4;
+  double rate = 0;  // 每个线程每秒的事件数，0 为不限速
+  int seconds = 10;
+  int drain = 10;
+  size_t data_size = 64;
+  std::string work_dir = "buried_e2e_bench";
+  std::string json_path;
+};
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string name = argv[i];
+    const char* value = argv[i + 1];
+    if (name == "--threads") {
+      options.threads = std::max(1, atoi(value));
+    } else if (name == "--rate") {
+      options.rate = atof(value);
+    } else if (name == "--seconds") {
+      options.seconds = std::max(1, atoi(value));
+    } else if (name == "--drain") {
+      options.drain = std::max(0, atoi(value));
+    } else if (name == "--data-size") {
+      options.data_size = static_cast<size_t>(atoll(value));
+    } else if (name == "--work-dir") {
+      options.work_dir = value;
+    } else if (name == "--json") {
+      options.json_path = value;
+    }
+  }
+  return options;
+}
+
+// 对数分桶的延迟直方图：每个 2 的幂区间再均分为 8 个桶，相对误差不超过 12.5%
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBuckets = 8;
+  static constexpr int kBuckets = 64 * kSubBuckets;
+
+  void Record(uint64_t ns) {
+    ++counts_[Index_(ns)];
+    ++total_;
+    max_ = std::max(max_, ns);
+  }
+
+  void Merge(const LatencyHistogram& other) {
+    for (int i = 0; i < kBuckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  // 返回分位点所在桶的上界
+  uint64_t Percentile(double p) const {
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * total_);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen > rank) {
+        return std::min(UpperBound_(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  uint64_t Total() const { return total_; }
+
+  uint64_t Max() const { return max_; }
+
+  // 按 2 的幂合并后的非空区间 [下界, 上界) 和计数
+  nlohmann::json Buckets() const {
+    nlohmann::json buckets = nlohmann::json::array();
+    for (int exp = 0; exp < 64; ++exp) {
+      uint64_t count = 0;
+      for (int sub = 0; sub < kSubBuckets; ++sub) {
+        count += counts_[exp * kSubBuckets + sub];
+      }
+      if (count != 0) {
+        uint64_t low = exp == 0 ? 0 : LowerBound_(exp * kSubBuckets);
+        buckets.push_back({{"ge_ns", low},
+                           {"lt_ns", UpperBound_(exp * kSubBuckets + 7)},
+                           {"count", count}});
+      }
+    }
+    return buckets;
+  }
+
+ private:
+  // 小于 8 的值直接作为下标，否则按最高位所在的指数和其后 3 位分桶
+  static int Index_(uint64_t v) {
+    if (v < kSubBuckets) {
+      return static_cast<int>(v);
+    }
+    int exp = 63;
+    while ((v >> exp) == 0) {
+      --exp;
+    }
+    int sub = static_cast<int>((v >> (exp - 3)) & (kSubBuckets - 1));
+    return (exp - 2) * kSubBuckets + sub;
+  }
+
+  static uint64_t LowerBound_(int index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    int exp = index / kSubBuckets + 2;
+    uint64_t sub = index % kSubBuckets;
+    return (uint64_t{1} << exp) | (sub << (exp - 3));
+  }
+
+  static uint64_t UpperBound_(int index) {
+    if (index < kSubBuckets) {
+      return index + 1;
+    }
+    int exp = index / kSubBuckets + 2;
+    return LowerBound_(index) + (uint64_t{1} << (exp - 3));
+  }
+
+ private:
+  uint64_t counts_[kBuckets] = {};
+  uint64_t total_ = 0;
+  uint64_t max_ = 0;
+};
+
+// 解压 gzip 或 zlib 格式的请求体，只处理本 SDK 产生的不带可选字段的 gzip 头
+bool Inflate(const std::string& body, const std::string& encoding,
+             std::string& out) {
+  size_t header = encoding == "gzip" ? 10 : 2;
+  size_t trailer = encoding == "gzip" ? 8 : 4;
+  if (body.size() < header + trailer) {
+    return false;
+  }
+  beast::zlib::inflate_stream stream;
+  beast::zlib::z_params params;
+  params.next_in = body.data() + header;
+  params.avail_in = body.size() - header - trailer;
+  char buffer[64 * 1024];
+  for (;;) {
+    params.next_out = buffer;
+    params.avail_out = sizeof(buffer);
+    beast::error_code ec;
+    stream.write(params, beast::zlib::Flush::sync, ec);
+    out.append(buffer, sizeof(buffer) - params.avail_out);
+    if (ec == beast::zlib::error::end_of_stream) {
+      return true;
+    }
+    if (ec) {
+      return false;
+    }
+    if (params.avail_in == 0 && params.avail_out != 0) {
+      return true;
+    }
+  }
+}
+
+size_t CountOf(std::string_view text, std::string_view pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string_view::npos;
+       pos = text.find(pattern, pos + pattern.size())) {
+    ++count;
+  }
+  return count;
+}
+
+// 回环地址上的收集端，每条连接一个线程，按 keep-alive 连续处理请求。
+// 解压后按 "report_id" 的个数统计收到的事件数
+class Collector {
+ public:
+  Collector()
+      : acceptor_(ioc_,
+                  tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)) {}
+
+  unsigned short Port() const { return acceptor_.local_endpoint().port(); }
+
+  // 线程在进程退出时随之结束，不需要等待
+  void Start() {
+    std::thread([this]() {
+      for (;;) {
+        beast::error_code ec;
+        tcp::socket socket(ioc_);
+        acceptor_.accept(socket, ec);
+        if (ec) {
+          return;
+        }
+        std::thread(&Collector::Serve_, this, std::move(socket)).detach();
+      }
+    }).detach();
+  }
+
+  uint64_t Events() const { return events_.load(); }
+  uint64_t Requests() const { return requests_.load(); }
+  uint64_t WireBytes() const { return wire_bytes_.load(); }
+  uint64_t Errors() const { return errors_.load(); }
+
+ private:
+  void Serve_(tcp::socket socket) {
+    beast::flat_buffer buffer;
+    for (;;) {
+      http::request_parser<http::string_body> parser;
+      parser.body_limit(64 * 1024 * 1024);
+      beast::error_code ec;
+      http::read(socket, buffer, parser, ec);
+      if (ec) {
+        return;
+      }
+      auto& req = parser.get();
+      wire_bytes_ += req.body().size();
+      std::string encoding(req[http::field::content_encoding]);
+      std::string plain;
+      const std::string* body = &req.body();
+      if (!encoding.empty()) {
+        if (!Inflate(req.body(), encoding, plain)) {
+          ++errors_;
+        }
+        body = &plain;
+      }
+      events_ += CountOf(*body, "\"report_id\"");
+      ++requests_;
+
+      http::response<http::string_body> res{http::status::ok, req.version()};
+      res.set(http::field::content_type, "application/json");
+      res.keep_alive(req.keep_alive());
+      res.body() = "{\"code\": 0}";
+      res.prepare_payload();
+      http::write(socket, res, ec);
+      if (ec || !req.keep_alive()) {
+        return;
+      }
+    }
+  }
+
+ private:
+  net::io_context ioc_;
+  tcp::acceptor acceptor_;
+  std::atomic<uint64_t> events_{0};
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<uint64_t> wire_bytes_{0};
+  std::atomic<uint64_t> errors_{0};
+};
+
+// 只读打开数据库统计等待上报和正在上报的行数，打开失败时返回 -1
+int64_t CountBacklog(const std::string& db_path) {
+  sqlite3* db = nullptr;
+  int64_t rows = -1;
+  if (sqlite3_open_v2(db_path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) ==
+      SQLITE_OK) {
+    sqlite3_busy_timeout(db, 1000);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM buried_data", -1, &stmt,
+                           nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+      rows = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+  }
+  sqlite3_close(db);
+  return rows;
+}
+
+struct Sample {
+  double seconds;
+  uint64_t produced;  // Buried_Report 调用次数
+  uint64_t uploaded;
+  int64_t backlog;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = ParseOptions(argc, argv);
+  std::filesystem::remove_all(options.work_dir);
+  std::string db_path =
+      (std::filesystem::path(options.work_dir) / "buried" / "buried.db")
+          .string();
+
+  Collector collector;
+  collector.Start();
+  std::string port = std::to_string(collector.Port());
+
+  Buried* buried = Buried_Create(options.work_dir.c_str());
+  BuriedConfig config = {};
+  config.host = "127.0.0.1";
+  config.port = port.c_str();
+  config.topic = "/buried";
+  config.user_id = "bench_user";
+  config.app_version = "1.0.0";
+  config.app_name = "buried_e2e_bench";
+  config.custom_data = "{}";
+  Buried_Start(buried, &config);
+
+  // data 为 {"payload":"xxx..."}，总长度约为 data_size
+  size_t padding = options.data_size > 14 ? options.data_size - 14 : 0;
+  std::string data = "{\"payload\":\"" + std::string(padding, 'x') + "\"}";
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> produced{0};
+  std::vector<LatencyHistogram> histograms(options.threads);
+  std::vector<std::thread> producers;
+  auto start = Clock::now();
+  for (int t = 0; t < options.threads; ++t) {
+    producers.emplace_back([&, t]() {
+      const std::string title = "bench_event_" + std::to_string(t % 8);
+      LatencyHistogram& histogram = histograms[t];
+      auto interval = options.rate > 0
+                          ? std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(1.0 /
+                                                              options.rate))
+                          : Clock::duration::zero();
+      auto next = Clock::now();
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (options.rate > 0) {
+          std::this_thread::sleep_until(next);
+          next += interval;
+        }
+        auto begin = Clock::now();
+        Buried_Report(buried, title.c_str(), data.c_str(), 1);
+        auto elapsed = Clock::now() - begin;
+        histogram.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()));
+        produced.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  // 每秒采样一次，生产结束后继续采样直到积压清空或超过 drain 秒
+  std::vector<Sample> samples;
+  auto take_sample = [&]() {
+    samples.push_back(
+        {std::chrono::duration<double>(Clock::now() - start).count(),
+         produced.load(), collector.Events(), CountBacklog(db_path)});
+  };
+  for (int i = 0; i < options.seconds; ++i) {
+    std::this_thread::sleep_until(start + std::chrono::seconds(i + 1));
+    take_sample();
+  }
+  stop = true;
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  Sample produce_end = samples.back();
+  // 积压清空且上一秒没有新的上报时认为在途批次都已完成
+  for (int i = 0; i < options.drain; ++i) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    uint64_t uploaded = samples.back().uploaded;
+    take_sample();
+    if (samples.back().backlog == 0 && samples.back().uploaded == uploaded) {
+      break;
+    }
+  }
+  Sample end = samples.back();
+  double upload_seconds = end.seconds;
+  for (const auto& sample : samples) {
+    if (sample.uploaded == end.uploaded) {
+      upload_seconds = sample.seconds;
+      break;
+    }
+  }
+
+  LatencyHistogram latency;
+  for (const auto& histogram : histograms) {
+    latency.Merge(histogram);
+  }
+  // 工作目录是新建的，积压从 0 开始
+  double produce_seconds = produce_end.seconds;
+  int64_t backlog_at_stop = std::max<int64_t>(produce_end.backlog, 0);
+  int64_t backlog_at_end = std::max<int64_t>(end.backlog, 0);
+  double calls_rate = latency.Total() / produce_seconds;
+  // 生产期间真正落库或已经上报的事件，环形队列写满时丢弃的不算
+  double ingest_rate = (produce_end.uploaded + backlog_at_stop) /
+                       produce_seconds;
+  double backlog_growth = backlog_at_stop / produce_seconds;
+  double upload_rate = end.uploaded / upload_seconds;
+  double upload_mb =
+      collector.WireBytes() / (1024.0 * 1024.0) / upload_seconds;
+  // 从开始生产到全部上报完成，端到端每秒送达的事件数
+  double sustained_rate = upload_rate;
+  int64_t dropped = static_cast<int64_t>(latency.Total()) -
+                    static_cast<int64_t>(end.uploaded) - backlog_at_end;
+
+  nlohmann::json result = {
+      {"threads", options.threads},
+      {"rate_per_thread", options.rate},
+      {"data_size", options.data_size},
+      {"produce_seconds", produce_seconds},
+      {"calls", latency.Total()},
+      {"calls_per_s", calls_rate},
+      {"latency_ns",
+       {{"p50", latency.Percentile(50)},
+        {"p90", latency.Percentile(90)},
+        {"p99", latency.Percentile(99)},
+        {"p999", latency.Percentile(99.9)},
+        {"max", latency.Max()},
+        {"buckets", latency.Buckets()}}},
+      {"ingest_events_per_s", ingest_rate},
+      {"backlog_rows_at_stop", backlog_at_stop},
+      {"backlog_growth_rows_per_s", backlog_growth},
+      {"backlog_rows_at_end", backlog_at_end},
+      {"uploaded", end.uploaded},
+      {"requests", collector.Requests()},
+      {"collector_errors", collector.Errors()},
+      {"upload_events_per_s", upload_rate},
+      {"upload_wire_mb_per_s", upload_mb},
+      // 没有上报也不在数据库里的事件，主要是环形队列写满时丢弃的
+      {"dropped", dropped},
+      {"sustained_events_per_s", sustained_rate},
+      {"samples", nlohmann::json::array()}};
+  for (const auto& sample : samples) {
+    result["samples"].push_back({{"seconds", sample.seconds},
+                                 {"calls", sample.produced},
+                                 {"uploaded", sample.uploaded},
+                                 {"backlog", sample.backlog}});
+  }
+  if (!options.json_path.empty()) {
+    std::ofstream(options.json_path) << result.dump(2) << std::endl;
+  }
+
+  // SDK 的控制台日志也在标准输出上，结果写到标准错误
+  fprintf(stderr,
+          "calls %llu in %.1fs (%.0f/s), caller latency p50 %llu ns, "
+          "p99 %llu ns, p99.9 %llu ns, max %llu ns\n"
+          "ingest %.0f events/s, backlog %lld rows at stop (%.0f rows/s), "
+          "%lld rows at end, dropped %lld\n"
+          "uploaded %llu events in %llu requests, %.0f events/s, "
+          "%.2f MB/s on the wire\n"
+          "sustained_events_per_s %.0f\n",
+          static_cast<unsigned long long>(latency.Total()), produce_seconds,
+          calls_rate, static_cast<unsigned long long>(latency.Percentile(50)),
+          static_cast<unsigned long long>(latency.Percentile(99)),
+          static_cast<unsigned long long>(latency.Percentile(99.9)),
+          static_cast<unsigned long long>(latency.Max()), ingest_rate,
+          static_cast<long long>(backlog_at_stop), backlog_growth,
+          static_cast<long long>(backlog_at_end),
+          static_cast<long long>(dropped),
+          static_cast<unsigned long long>(end.uploaded),
+          static_cast<unsigned long long>(collector.Requests()), upload_rate,
+          upload_mb, sustained_rate);
+
+  Buried_Destroy(buried);
+  return 0;
+}
\ No newline at end of file
@@ -3,6 +3,37 @@
 
 TEST(BuriedBasicTest, Test1) { Buried_Create("D:/BuriedPointSDK"); }
 
+// 参数检查：指针为空时长度必须为 0
+TEST(BuriedBasicTest, InvalidParamTest) {
+  EXPECT_NE(Buried_ReportN(nullptr, "title", 5, "data", 4, 1), 0);
+  Buried* buried = Buried_Create("D:/BuriedPointSDK");
+  EXPECT_NE(Buried_ReportN(buried, nullptr, 5, "data", 4, 1), 0);
+  EXPECT_NE(Buried_ReportN(buried, "title", 5, nullptr, 4, 1), 0);
+
+  BuriedEvent events[2] = {{"title", 5, "data", 4, 1}, {nullptr, 5, "", 0, 1}};
+  EXPECT_NE(Buried_ReportBatch(nullptr, events, 1), 0);
+  EXPECT_NE(Buried_ReportBatch(buried, nullptr, 1), 0);
+  EXPECT_NE(Buried_ReportBatch(buried, events, 2), 0);
+
+  EXPECT_EQ(Buried_EventBegin(nullptr, "title", 5, 1), nullptr);
+  EXPECT_EQ(Buried_EventBegin(buried, nullptr, 5, 1), nullptr);
+  BuriedEventBuilder* builder = Buried_EventBegin(buried, "title", 5, 1);
+  ASSERT_NE(builder, nullptr);
+  EXPECT_NE(Buried_EventAddInt(builder, nullptr, 3, 1), 0);
+  EXPECT_NE(Buried_EventAddString(builder, "key", 3, nullptr, 5), 0);
+  EXPECT_EQ(Buried_EventAddDouble(builder, "key", 3, 1.5), 0);
+  Buried_EventCancel(builder);
+
+  // 上报参数取值不合法时不启动
+  BuriedConfig config = {};
+  config.overflow_policy = 7;
+  EXPECT_EQ(Buried_Start(buried, &config), 1);
+  config.overflow_policy = 0;
+  config.compression = 3;
+  EXPECT_EQ(Buried_Start(buried, &config), 1);
+  Buried_Destroy(buried);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
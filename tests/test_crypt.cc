@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "src/crypt/crypt.h"
 
@@ -13,4 +18,136 @@ TEST(CryptTest, BasicTest) {
   EXPECT_TRUE(!decrypted.empty());
   EXPECT_EQ(input, decrypted);
   delete crypt;
+}
+
+TEST(CryptTest, GCMTest) {
+  std::string key = buried::AESCrypt::GetKey("salt", "password");
+  buried::AESGCMCrypt crypt(key);
+
+  std::string input = "hello world";
+  std::string encrypted = crypt.Encrypt(input);
+  // 没有填充，只多出 nonce 和 tag
+  EXPECT_EQ(encrypted.size(), input.size() + buried::AESGCMCrypt::kNonceSize +
+                                  buried::AESGCMCrypt::kTagSize);
+  EXPECT_EQ(crypt.Decrypt(encrypted), input);
+
+  // 每条消息的 nonce 不同，相同明文的密文也不同
+  EXPECT_NE(crypt.Encrypt(input), encrypted);
+
+  // 另一个实例（例如对象池中的其他实例）可以解密
+  buried::AESGCMCrypt other(key);
+  EXPECT_EQ(other.Decrypt(encrypted), input);
+
+  std::string large(64 * 1024, 'x');
+  EXPECT_EQ(crypt.Decrypt(crypt.Encrypt(large)), large);
+}
+
+// 被篡改或截断的密文、错误的密钥都无法解密
+TEST(CryptTest, GCMTamperTest) {
+  std::string key = buried::AESCrypt::GetKey("salt", "password");
+  buried::AESGCMCrypt crypt(key);
+  std::string encrypted = crypt.Encrypt("hello world");
+
+  for (size_t i = 0; i < encrypted.size(); ++i) {
+    std::string tampered = encrypted;
+    tampered[i] ^= 0x01;
+    EXPECT_TRUE(crypt.Decrypt(tampered).empty());
+  }
+  EXPECT_TRUE(crypt.Decrypt(encrypted.substr(0, 20)).empty());
+
+  buried::AESGCMCrypt wrong(buried::AESCrypt::GetKey("salt", "other"));
+  EXPECT_TRUE(wrong.Decrypt(encrypted).empty());
+}
+
+TEST(CryptTest, CreateCryptTest) {
+  std::string key = buried::AESCrypt::GetKey("salt", "password");
+  auto cbc = buried::CreateCrypt(buried::CipherMode::kAesCbc, key);
+  auto gcm = buried::CreateCrypt(buried::CipherMode::kAesGcm, key);
+  ASSERT_TRUE(cbc && gcm);
+  EXPECT_EQ(cbc->Decrypt(cbc->Encrypt("cbc")), "cbc");
+  EXPECT_EQ(gcm->Decrypt(gcm->Encrypt("gcm")), "gcm");
+  EXPECT_TRUE(gcm->Decrypt(cbc->Encrypt("cbc")).empty());
+  EXPECT_EQ(buried::CreateCrypt(static_cast<buried::CipherMode>(7), key),
+            nullptr);
+}
+
+// 写入调用方缓冲区的结果与字符串接口互通，缓冲区不够时失败
+TEST(CryptTest, IntoTest) {
+  std::string key = buried::AESCrypt::GetKey("salt", "password");
+  std::string input = "hello world";
+  auto in = std::as_bytes(std::span(input));
+  for (buried::CipherMode mode :
+       {buried::CipherMode::kAesCbc, buried::CipherMode::kAesGcm}) {
+    auto crypt = buried::CreateCrypt(mode, key);
+    std::vector<std::byte> encrypted(crypt->EncryptedSize(input.size()));
+    size_t written = 0;
+    ASSERT_TRUE(crypt->EncryptInto(in, encrypted, written));
+    EXPECT_LE(written, encrypted.size());
+    encrypted.resize(written);
+    std::string encrypted_str(reinterpret_cast<char*>(encrypted.data()),
+                              encrypted.size());
+    EXPECT_EQ(crypt->Decrypt(encrypted_str), input);
+
+    std::string other = crypt->Encrypt(input);
+    std::vector<std::byte> decrypted(crypt->DecryptedSize(other.size()));
+    auto other_bytes = std::as_bytes(std::span(other));
+    ASSERT_TRUE(crypt->DecryptInto(other_bytes, decrypted, written));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(decrypted.data()), written),
+              input);
+
+    std::vector<std::byte> small(input.size());
+    EXPECT_FALSE(crypt->EncryptInto(in, small, written));
+  }
+}
+
+// 任意切分的流式加解密与一次性加解密互通，GCM 截断或篡改时 Finish 失败
+TEST(CryptTest, StreamTest) {
+  std::string key = buried::AESCrypt::GetKey("salt", "password");
+  std::string input;
+  for (int i = 0; i < 1000; ++i) {
+    input += std::to_string(i);
+  }
+  for (buried::CipherMode mode :
+       {buried::CipherMode::kAesCbc, buried::CipherMode::kAesGcm}) {
+    auto crypt = buried::CreateCrypt(mode, key);
+    buried::CipherStream encrypt(mode, key, buried::CipherDirection::kEncrypt);
+    buried::CipherStream decrypt(mode, key, buried::CipherDirection::kDecrypt);
+    for (size_t step : {1, 7, 16, 33, 4096}) {
+      std::string encrypted;
+      ASSERT_TRUE(encrypt.Begin(encrypted));
+      for (size_t i = 0; i < input.size(); i += step) {
+        ASSERT_TRUE(encrypt.Update(input.data() + i,
+                                   std::min(step, input.size() - i),
+                                   encrypted));
+      }
+      ASSERT_TRUE(encrypt.Finish(encrypted));
+      EXPECT_EQ(crypt->Decrypt(encrypted), input);
+      if (mode == buried::CipherMode::kAesCbc) {
+        EXPECT_EQ(encrypted, crypt->Encrypt(input));
+      }
+
+      std::string decrypted;
+      ASSERT_TRUE(decrypt.Begin(decrypted));
+      for (size_t i = 0; i < encrypted.size(); i += step) {
+        ASSERT_TRUE(decrypt.Update(encrypted.data() + i,
+                                   std::min(step, encrypted.size() - i),
+                                   decrypted));
+      }
+      ASSERT_TRUE(decrypt.Finish(decrypted));
+      EXPECT_EQ(decrypted, input);
+    }
+  }
+
+  buried::CipherStream decrypt(buried::CipherMode::kAesGcm, key,
+                               buried::CipherDirection::kDecrypt);
+  std::string encrypted =
+      buried::AESGCMCrypt(key).Encrypt(std::string(100, 'x'));
+  std::string out;
+  encrypted[50] ^= 0x01;
+  ASSERT_TRUE(decrypt.Begin(out));
+  ASSERT_TRUE(decrypt.Update(encrypted.data(), encrypted.size(), out));
+  EXPECT_FALSE(decrypt.Finish(out));
+  ASSERT_TRUE(decrypt.Begin(out));
+  ASSERT_TRUE(decrypt.Update(encrypted.data(), 20, out));
+  EXPECT_FALSE(decrypt.Finish(out));
 }
\ No newline at end of file
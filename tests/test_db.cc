@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <filesystem>
 
 #include "gtest/gtest.h"
@@ -76,5 +77,305 @@ TEST(DbTest, DISABLED_BasicTest) {
   EXPECT_EQ(datas.size(), 10);
 
   // 删除数据库文件，清理环境
+  std::filesystem::remove(db_path);
+}
+
+// 批量插入测试
+TEST(DbTest, DISABLED_InsertDatasTest) {
+  std::filesystem::path db_path("insert_datas.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+
+    std::vector<buried::BuriedDb::Data> datas;
+    for (int i = 0; i < 1000; ++i) {
+      datas.push_back(buried::BuriedDb::Data{
+          -1, i, static_cast<uint64_t>(i),
+          std::vector<char>{'h', 'e', 'l', 'l', 'o'}});
+    }
+    db.InsertDatas(datas);
+    db.InsertDatas({});
+
+    auto result = db.QueryData(2000);
+    EXPECT_EQ(result.size(), 1000);
+    EXPECT_EQ(result[0].priority, 999);
+    EXPECT_EQ(result[0].content, datas[0].content);
+  }
+
+  std::filesystem::remove(db_path);
+}
+
+// 批量删除测试，覆盖 id 连续和不连续两种情况
+TEST(DbTest, DISABLED_DeleteDatasTest) {
+  std::filesystem::path db_path("delete_datas.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+
+    std::vector<buried::BuriedDb::Data> datas;
+    for (int i = 0; i < 3000; ++i) {
+      datas.push_back(buried::BuriedDb::Data{
+          -1, 1, static_cast<uint64_t>(i), std::vector<char>{'h'}});
+    }
+    db.InsertDatas(datas);
+
+    auto result = db.QueryData(5000);
+    EXPECT_EQ(result.size(), 3000);
+
+    // 删除所有 id 为偶数的行，超过单条语句的 id 上限
+    std::vector<buried::BuriedDb::Data> even;
+    for (const auto& data : result) {
+      if (data.id % 2 == 0) {
+        even.push_back(data);
+      }
+    }
+    db.DeleteDatas(even);
+    result = db.QueryData(5000);
+    EXPECT_EQ(result.size(), 3000 - even.size());
+    for (const auto& data : result) {
+      EXPECT_NE(data.id % 2, 0);
+    }
+
+    db.DeleteDatas(result);
+    EXPECT_EQ(db.QueryData(5000).size(), 0);
+  }
+
+  std::filesystem::remove(db_path);
+}
+
+// 键集分页测试，逐页取出的顺序应与一次性查询一致
+TEST(DbTest, DISABLED_QueryDataAfterTest) {
+  std::filesystem::path db_path("query_after.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+
+    std::vector<buried::BuriedDb::Data> datas;
+    for (int i = 0; i < 1000; ++i) {
+      datas.push_back(buried::BuriedDb::Data{
+          -1, i % 7, static_cast<uint64_t>(i), std::vector<char>{'h'}});
+    }
+    db.InsertDatas(datas);
+
+    auto all = db.QueryData(2000);
+    EXPECT_EQ(all.size(), 1000);
+
+    std::vector<buried::BuriedDb::Data> paged = db.QueryData(33);
+    while (true) {
+      buried::BuriedDb::Cursor cursor{paged.back().priority, paged.back().id};
+      auto page = db.QueryDataAfter(cursor, 33);
+      if (page.empty()) {
+        break;
+      }
+      paged.insert(paged.end(), page.begin(), page.end());
+    }
+
+    EXPECT_EQ(paged.size(), all.size());
+    for (size_t i = 0; i < all.size() && i < paged.size(); ++i) {
+      EXPECT_EQ(paged[i].id, all[i].id);
+    }
+    for (size_t i = 1; i < all.size(); ++i) {
+      EXPECT_TRUE(all[i - 1].priority > all[i].priority ||
+                  (all[i - 1].priority == all[i].priority &&
+                   all[i - 1].id < all[i].id));
+    }
+  }
+
+  std::filesystem::remove(db_path);
+}
+
+// 各存储档位下读写都正常，查询连接能读到写连接提交的数据
+TEST(DbTest, DISABLED_StorageProfileTest) {
+  const buried::BuriedDb::StorageProfile profiles[] = {
+      buried::BuriedDb::StorageProfile::kDurable,
+      buried::BuriedDb::StorageProfile::kBalanced,
+      buried::BuriedDb::StorageProfile::kThroughput};
+  for (auto profile : profiles) {
+    std::filesystem::path db_path("storage_profile.db");
+    if (std::filesystem::exists(db_path)) {
+      std::filesystem::remove(db_path);
+    }
+
+    {
+      buried::BuriedDb db(db_path.string(), profile);
+      for (int i = 0; i < 10; ++i) {
+        buried::BuriedDb::Data data{-1, i, static_cast<uint64_t>(i),
+                                    std::vector<char>{'h'}};
+        db.InsertData(data);
+        EXPECT_EQ(db.QueryData(100).size(), i + 1);
+      }
+    }
+
+    std::filesystem::remove(db_path);
+  }
+}
+
+// 上报中的数据不会被重复查询，失败后恢复为等待上报
+TEST(DbTest, DISABLED_InFlightTest) {
+  std::filesystem::path db_path("in_flight.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+
+    std::vector<buried::BuriedDb::Data> datas;
+    for (int i = 0; i < 30; ++i) {
+      datas.push_back(buried::BuriedDb::Data{
+          -1, i, static_cast<uint64_t>(i), std::vector<char>{'h'}});
+    }
+    db.InsertDatas(datas);
+
+    auto first = db.QueryData(10);
+    db.MarkInFlight(first);
+    auto second = db.QueryData(10);
+    db.MarkInFlight(second);
+    EXPECT_EQ(second.size(), 10);
+    EXPECT_LT(second[0].priority, first[9].priority);
+    EXPECT_EQ(db.QueryData(100).size(), 10);
+
+    // 第一批确认后删除，第二批失败后重新等待上报
+    db.DeleteDatas(first);
+    db.MarkPending(second);
+    EXPECT_EQ(db.QueryData(100).size(), 20);
+
+    db.MarkInFlight(db.QueryData(5));
+    EXPECT_EQ(db.QueryData(100).size(), 15);
+    db.ResetInFlight();
+    EXPECT_EQ(db.QueryData(100).size(), 20);
+
+    // 无法解密的数据保留，但不会被再次查询，也不会被启动恢复
+    db.MarkUnreadable(db.QueryData(3));
+    EXPECT_EQ(db.QueryData(100).size(), 17);
+    db.ResetInFlight();
+    EXPECT_EQ(db.QueryData(100).size(), 17);
+    EXPECT_EQ(db.CountUnreadable(), 3);
+
+    // 无法读取的数据超过保留时长或条数上限后删除，等待上报的数据不受影响
+    EXPECT_EQ(db.PurgeUnreadable(18, 100), 1);
+    EXPECT_EQ(db.CountUnreadable(), 2);
+    db.MarkUnreadable(db.QueryData(3));
+    EXPECT_EQ(db.PurgeUnreadable(0, 2), 3);
+    EXPECT_EQ(db.CountUnreadable(), 2);
+    EXPECT_EQ(db.QueryData(100).size(), 14);
+  }
+
+  std::filesystem::remove(db_path);
+}
+
+// 公共字段头的写入、查询和清理
+TEST(DbTest, DISABLED_HeaderTest) {
+  std::filesystem::path db_path("header.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+
+    int32_t old_id = db.InsertHeader(std::vector<char>{'o', 'l', 'd'});
+    int32_t new_id = db.InsertHeader(std::vector<char>{'n', 'e', 'w'});
+    EXPECT_NE(old_id, new_id);
+
+    buried::BuriedDb::Header header;
+    EXPECT_TRUE(db.QueryHeader(old_id, header));
+    EXPECT_EQ(header.content, (std::vector<char>{'o', 'l', 'd'}));
+
+    buried::BuriedDb::Data data{-1, 1, 1, std::vector<char>{'h'}};
+    data.header_id = old_id;
+    db.InsertData(data);
+    auto datas = db.QueryData(10);
+    ASSERT_EQ(datas.size(), 1);
+    EXPECT_EQ(datas[0].header_id, old_id);
+
+    // 仍被引用的头和当前头都不会被清理
+    db.DeleteUnusedHeaders(new_id);
+    EXPECT_TRUE(db.QueryHeader(old_id, header));
+    EXPECT_TRUE(db.QueryHeader(new_id, header));
+
+    db.DeleteDatas(datas);
+    db.DeleteUnusedHeaders(new_id);
+    EXPECT_FALSE(db.QueryHeader(old_id, header));
+    EXPECT_TRUE(db.QueryHeader(new_id, header));
+  }
+
+  std::filesystem::remove(db_path);
+}
+
+// 只查询摘要，再按 id 分页读取内容
+TEST(DbTest, DISABLED_SummaryTest) {
+  std::filesystem::path db_path("summary.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+
+    std::vector<buried::BuriedDb::Data> datas;
+    for (int i = 0; i < 20; ++i) {
+      datas.push_back(buried::BuriedDb::Data{-1, i % 4,
+                                             static_cast<uint64_t>(i),
+                                             std::vector<char>(i + 1, 'h')});
+    }
+    db.InsertDatas(datas);
+
+    auto summaries = db.QuerySummaries(10);
+    auto rows = db.QueryData(10);
+    ASSERT_EQ(summaries.size(), 10);
+    std::vector<int32_t> ids;
+    for (size_t i = 0; i < summaries.size(); ++i) {
+      EXPECT_EQ(summaries[i].id, rows[i].id);
+      EXPECT_EQ(summaries[i].priority, rows[i].priority);
+      EXPECT_EQ(summaries[i].size, rows[i].content.size());
+      ids.push_back(summaries[i].id);
+    }
+
+    // 上报中的数据仍然可以按 id 读取，顺序与摘要一致
+    db.MarkInFlight(rows);
+    std::reverse(ids.begin(), ids.end());
+    auto by_ids = db.QueryDataByIds(ids);
+    ASSERT_EQ(by_ids.size(), rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      EXPECT_EQ(by_ids[i].id, rows[i].id);
+      EXPECT_EQ(by_ids[i].content, rows[i].content);
+    }
+  }
+
+  std::filesystem::remove(db_path);
+}
+
+// 字典条目使用调用方分配的 id，重复写入时覆盖
+TEST(DbTest, DISABLED_StringTest) {
+  std::filesystem::path db_path("string.db");
+  if (std::filesystem::exists(db_path)) {
+    std::filesystem::remove(db_path);
+  }
+
+  {
+    buried::BuriedDb db(db_path.string());
+    EXPECT_TRUE(db.QueryStrings().empty());
+
+    db.InsertStrings({buried::BuriedDb::DictString{2, {'v'}},
+                      buried::BuriedDb::DictString{1, {'c'}}});
+    db.InsertStrings({buried::BuriedDb::DictString{2, {'s'}}});
+    auto strings = db.QueryStrings();
+    ASSERT_EQ(strings.size(), 2);
+    EXPECT_EQ(strings[0].id, 1);
+    EXPECT_EQ(strings[0].content, std::vector<char>{'c'});
+    EXPECT_EQ(strings[1].id, 2);
+    EXPECT_EQ(strings[1].content, std::vector<char>{'s'});
+  }
+
   std::filesystem::remove(db_path);
 }
\ No newline at end of file
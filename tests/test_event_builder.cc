@@ -0,0 +1,90 @@
+#include <cmath>
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "src/report/event_builder.h"
+#include "src/third_party/nlohmann/json.hpp"
+
+// 各类型属性编码成的 JSON 对象可以被正常解析
+TEST(EventBuilderTest, TypesTest) {
+  buried::EventBuilder builder("click", 3);
+  builder.AddInt("min", std::numeric_limits<int64_t>::min());
+  builder.AddInt("max", std::numeric_limits<int64_t>::max());
+  builder.AddDouble("pi", 3.141592653589793);
+  builder.AddDouble("nan", std::nan(""));
+  builder.AddBool("ok", true);
+  builder.AddString("name", "buried");
+  buried::BuriedData data = builder.Finish();
+
+  EXPECT_EQ(data.title, "click");
+  EXPECT_EQ(data.priority, 3);
+  EXPECT_TRUE(data.data_is_json);
+
+  auto json = nlohmann::json::parse(data.data);
+  EXPECT_EQ(json["min"].get<int64_t>(), std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(json["max"].get<int64_t>(), std::numeric_limits<int64_t>::max());
+  EXPECT_EQ(json["pi"].get<double>(), 3.141592653589793);
+  EXPECT_TRUE(json["nan"].is_null());
+  EXPECT_EQ(json["ok"].get<bool>(), true);
+  EXPECT_EQ(json["name"].get<std::string>(), "buried");
+}
+
+// key 和字符串值中的特殊字符被正确转义
+TEST(EventBuilderTest, EscapeTest) {
+  std::string value = "quote\" slash\\ line\n tab\t \x01 中文";
+  buried::EventBuilder builder("escape", 0);
+  builder.AddString("k\"ey", value);
+  buried::BuriedData data = builder.Finish();
+
+  auto json = nlohmann::json::parse(data.data);
+  EXPECT_EQ(json["k\"ey"].get<std::string>(), value);
+}
+
+// 没有属性时是空对象
+TEST(EventBuilderTest, EmptyTest) {
+  buried::EventBuilder builder("empty", 0);
+  EXPECT_EQ(builder.Finish().data, "{}");
+}
+
+// 非法的 UTF-8 替换为 U+FFFD，合法的多字节字符原样保留
+TEST(EventBuilderTest, InvalidUtf8Test) {
+  struct Case {
+    std::string input;
+    std::string expected;
+  };
+  const std::string fffd = "\xEF\xBF\xBD";
+  Case cases[] = {
+      {"\xE4\xB8\xAD\xF0\x9F\x98\x80", "\xE4\xB8\xAD\xF0\x9F\x98\x80"},
+      {"a\xFF" "b", "a" + fffd + "b"},
+      // 过长编码
+      {"\xC0\xAF", fffd + fffd},
+      // 代理区
+      {"\xED\xA0\x80", fffd + fffd + fffd},
+      // 超过 U+10FFFF
+      {"\xF4\x90\x80\x80", fffd + fffd + fffd + fffd},
+      // 截断的序列只替换一次
+      {"\xE4\xB8x", fffd + "x"},
+      {"end\xF0\x9F\x98", "end" + fffd},
+  };
+  for (const auto& item : cases) {
+    std::string out;
+    buried::AppendJsonString(out, item.input);
+    EXPECT_EQ(nlohmann::json::parse(out).get<std::string>(), item.expected);
+  }
+}
+
+// 标题、key 和字符串值中的非法 UTF-8 在构造时被替换，data 可以被解析
+TEST(EventBuilderTest, RepairUtf8Test) {
+  const std::string fffd = "\xEF\xBF\xBD";
+  buried::EventBuilder builder("ti\xFEtle", 0);
+  builder.AddString("k\xC3", "v\xE4\xB8\xAD\xE4");
+  buried::BuriedData data = builder.Finish();
+
+  EXPECT_EQ(data.title, "ti" + fffd + "tle");
+  auto json = nlohmann::json::parse(data.data);
+  EXPECT_EQ(json["k" + fffd].get<std::string>(), "v\xE4\xB8\xAD" + fffd);
+
+  std::string valid = "\xE4\xB8\xAD\xE6\x96\x87";
+  buried::RepairUtf8(valid);
+  EXPECT_EQ(valid, "\xE4\xB8\xAD\xE6\x96\x87");
+}
\ No newline at end of file
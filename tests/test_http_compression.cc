@@ -0,0 +1,117 @@
+#include <string>
+
+#include "boost/beast/zlib/inflate_stream.hpp"
+#include "boost/crc.hpp"
+#include "gtest/gtest.h"
+#include "src/report/http_compression.h"
+
+namespace zlib = boost::beast::zlib;
+
+// 解压原始 deflate 数据
+static std::string RawInflate(const char* data, size_t size,
+                              size_t original_size) {
+  std::string out(original_size, '\0');
+  zlib::inflate_stream stream;
+  zlib::z_params params;
+  params.next_in = data;
+  params.avail_in = size;
+  params.next_out = &out[0];
+  params.avail_out = out.size();
+  boost::system::error_code ec;
+  stream.write(params, zlib::Flush::finish, ec);
+  EXPECT_EQ(ec, zlib::error::end_of_stream);
+  out.resize(params.total_out);
+  return out;
+}
+
+static std::string MakeBody() {
+  std::string body = "[";
+  for (int i = 0; i < 100; ++i) {
+    body += "{\"user_id\":\"buried\",\"device_id\":\"device\",\"index\":" +
+            std::to_string(i) + "},";
+  }
+  body.back() = ']';
+  return body;
+}
+
+// gzip 格式：10 字节头 + deflate 数据 + CRC32 + 原始长度
+TEST(HttpCompressionTest, GzipTest) {
+  std::string body = MakeBody();
+  buried::HttpCompression compression;
+  std::string out;
+  EXPECT_TRUE(buried::CompressBody(compression, body, out));
+  EXPECT_LT(out.size(), body.size() / 4);
+  EXPECT_STREQ(buried::EncodingName(compression.encoding), "gzip");
+
+  ASSERT_GT(out.size(), 18);
+  EXPECT_EQ(static_cast<uint8_t>(out[0]), 0x1f);
+  EXPECT_EQ(static_cast<uint8_t>(out[1]), 0x8b);
+  std::string plain = RawInflate(out.data() + 10, out.size() - 18, body.size());
+  EXPECT_EQ(plain, body);
+
+  boost::crc_32_type crc;
+  crc.process_bytes(body.data(), body.size());
+  uint32_t checksum = 0;
+  uint32_t length = 0;
+  for (int i = 3; i >= 0; --i) {
+    checksum = (checksum << 8) | static_cast<uint8_t>(out[out.size() - 8 + i]);
+    length = (length << 8) | static_cast<uint8_t>(out[out.size() - 4 + i]);
+  }
+  EXPECT_EQ(checksum, crc.checksum());
+  EXPECT_EQ(length, body.size());
+}
+
+// deflate 格式：2 字节 zlib 头 + deflate 数据 + Adler-32
+TEST(HttpCompressionTest, DeflateTest) {
+  std::string body = MakeBody();
+  buried::HttpCompression compression;
+  compression.encoding = buried::HttpEncoding::kDeflate;
+  compression.level = 9;
+  std::string out;
+  EXPECT_TRUE(buried::CompressBody(compression, body, out));
+  EXPECT_STREQ(buried::EncodingName(compression.encoding), "deflate");
+
+  ASSERT_GT(out.size(), 6);
+  EXPECT_EQ((static_cast<uint8_t>(out[0]) * 256 + static_cast<uint8_t>(out[1])) %
+                31,
+            0);
+  std::string plain = RawInflate(out.data() + 2, out.size() - 6, body.size());
+  EXPECT_EQ(plain, body);
+}
+
+// 未开启或低于阈值时不压缩
+TEST(HttpCompressionTest, ThresholdTest) {
+  std::string body = MakeBody();
+  std::string out;
+  buried::HttpCompression compression;
+  compression.min_size = body.size() + 1;
+  EXPECT_FALSE(buried::CompressBody(compression, body, out));
+
+  compression.min_size = 0;
+  compression.encoding = buried::HttpEncoding::kIdentity;
+  EXPECT_FALSE(buried::CompressBody(compression, body, out));
+  EXPECT_STREQ(buried::EncodingName(compression.encoding), "");
+}
+
+// 分段压缩的结果与整体压缩一样可以完整解压
+TEST(HttpCompressionTest, StreamTest) {
+  std::string body = MakeBody();
+  buried::BodyCompressor compressor(buried::HttpCompression{});
+  std::string out;
+  for (size_t pos = 0; pos < body.size(); pos += 100) {
+    std::string part = body.substr(pos, 100);
+    EXPECT_TRUE(compressor.Write(part.data(), part.size(), out));
+  }
+  EXPECT_TRUE(compressor.Finish(out));
+  EXPECT_LT(out.size(), body.size() / 4);
+  std::string plain = RawInflate(out.data() + 10, out.size() - 18, body.size());
+  EXPECT_EQ(plain, body);
+
+  // 重置后可以再次使用
+  compressor.Reset();
+  std::string again;
+  EXPECT_TRUE(compressor.Write(body.data(), body.size(), again));
+  EXPECT_TRUE(compressor.Finish(again));
+  EXPECT_EQ(RawInflate(again.data() + 10, again.size() - 18, body.size()),
+            body);
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/crypt/crypt.h"
+#include "src/crypt/crypt_pool.h"
+#include "src/crypt/key_provider.h"
+
+// 旧 id 的密钥与旧版本一致，其他 id 各不相同
+TEST(KeyProviderTest, Pbkdf2Test) {
+  buried::KeyProvider keys(buried::KeyProvider::Pbkdf2("salt", "password"));
+  std::string legacy = keys.GetKey(buried::KeyProvider::kLegacyKeyId);
+  EXPECT_EQ(legacy, buried::AESCrypt::GetKey("salt", "password"));
+  EXPECT_EQ(legacy.size(), 32);
+
+  std::string rotated = keys.GetKey(1);
+  EXPECT_EQ(rotated.size(), 32);
+  EXPECT_NE(rotated, legacy);
+  EXPECT_NE(keys.GetKey(2), rotated);
+  EXPECT_EQ(keys.GetKey(1), rotated);
+}
+
+// 多个线程同时请求同一个 id，只派生一次
+TEST(KeyProviderTest, DeriveOnceTest) {
+  std::atomic<int> derived{0};
+  buried::KeyProvider keys([&derived](int32_t key_id) {
+    ++derived;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return std::string(32, static_cast<char>('a' + key_id));
+  });
+  EXPECT_FALSE(keys.IsReady(0));
+
+  std::vector<std::thread> threads;
+  std::vector<std::string> results(4);
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back(
+        [&keys, &results, i]() { results[i] = keys.GetKey(0); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(derived, 1);
+  EXPECT_TRUE(keys.IsReady(0));
+  for (const auto& result : results) {
+    EXPECT_EQ(result, std::string(32, 'a'));
+  }
+}
+
+// 按算法和密钥 id 取得的对象池只能解密对应的数据
+TEST(KeyProviderTest, CryptPoolsTest) {
+  auto keys = std::make_shared<buried::KeyProvider>(
+      buried::KeyProvider::Pbkdf2("salt", "password"));
+  buried::CryptPools pools(keys);
+  auto* gcm_1 = pools.Get(buried::CipherMode::kAesGcm, 1);
+  auto* gcm_2 = pools.Get(buried::CipherMode::kAesGcm, 2);
+  ASSERT_NE(gcm_1, nullptr);
+  ASSERT_NE(gcm_2, nullptr);
+  EXPECT_NE(gcm_1, gcm_2);
+  EXPECT_EQ(pools.Get(buried::CipherMode::kAesGcm, 1), gcm_1);
+  EXPECT_EQ(pools.Get(7, 1), nullptr);
+
+  std::string encrypted = gcm_1->Acquire()->Encrypt("hello");
+  EXPECT_EQ(gcm_1->Acquire()->Decrypt(encrypted), "hello");
+  EXPECT_TRUE(gcm_2->Acquire()->Decrypt(encrypted).empty());
+}
+
+// 同一线程总是取到同一个实例，不同线程各有一个
+TEST(KeyProviderTest, LocalCryptTest) {
+  auto keys = std::make_shared<buried::KeyProvider>(
+      buried::KeyProvider::Pbkdf2("salt", "password"));
+  buried::CryptPools pools(keys);
+  auto* pool = pools.Get(buried::CipherMode::kAesCbc, 0);
+  ASSERT_NE(pool, nullptr);
+  buried::Crypt* local = &pool->Local();
+  EXPECT_EQ(&pool->Local(), local);
+  EXPECT_NE(&pools.Get(buried::CipherMode::kAesGcm, 0)->Local(), local);
+
+  buried::Crypt* other = nullptr;
+  std::string decrypted;
+  std::string encrypted = local->Encrypt("hello");
+  std::thread thread([&]() {
+    other = &pool->Local();
+    decrypted = other->Decrypt(encrypted);
+  });
+  thread.join();
+  EXPECT_NE(other, local);
+  EXPECT_EQ(decrypted, "hello");
+}
+// 派生失败不缓存，下一次使用时重新派生；空密钥创建的加解密器不可用
+TEST(KeyProviderTest, DeriveFailureTest) {
+  EXPECT_FALSE(buried::AESCrypt("").Ready());
+  EXPECT_FALSE(buried::AESGCMCrypt("").Ready());
+  EXPECT_TRUE(buried::AESCrypt("").Encrypt("hello").empty());
+
+  std::atomic<int> derived{0};
+  auto keys = std::make_shared<buried::KeyProvider>([&derived](int32_t) {
+    return ++derived == 1 ? std::string() : std::string(32, 'k');
+  });
+  buried::CryptPools pools(keys);
+  auto* pool = pools.Get(buried::CipherMode::kAesCbc, 0);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_FALSE(pool->Local().Ready());
+  EXPECT_FALSE(keys->IsReady(0));
+
+  buried::Crypt& crypt = pool->Local();
+  EXPECT_TRUE(crypt.Ready());
+  EXPECT_EQ(crypt.Decrypt(crypt.Encrypt("hello")), "hello");
+  EXPECT_EQ(keys->GetKey(0), std::string(32, 'k'));
+  EXPECT_EQ(derived, 2);
+}
+// 对象池反复创建和销毁，线程缓存只保留存活对象池的实例
+TEST(KeyProviderTest, LocalCryptReleaseTest) {
+  auto keys = std::make_shared<buried::KeyProvider>(
+      buried::KeyProvider::Pbkdf2("salt", "password"));
+  for (int i = 0; i < 100; ++i) {
+    buried::CryptPools pools(keys);
+    buried::Crypt& crypt = pools.Get(buried::CipherMode::kAesCbc, 0)->Local();
+    EXPECT_EQ(crypt.Decrypt(crypt.Encrypt("hello")), "hello");
+  }
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "src/report/report_scheduler.h"
+
+// 有积压时批次翻倍、间隔减半，积压消化后回到正常值
+TEST(ReportSchedulerTest, BacklogTest) {
+  buried::ReportSchedulerOptions options;
+  options.min_batch_rows = 10;
+  options.max_batch_rows = 40;
+  options.min_interval_ms = 1000;
+  options.base_interval_ms = 4000;
+  buried::ReportScheduler scheduler(options);
+  EXPECT_EQ(scheduler.BatchRows(), 10);
+  EXPECT_EQ(scheduler.Interval().count(), 4000);
+
+  scheduler.OnSuccess(true);
+  EXPECT_EQ(scheduler.BatchRows(), 20);
+  EXPECT_EQ(scheduler.Interval().count(), 2000);
+  scheduler.OnSuccess(true);
+  scheduler.OnSuccess(true);
+  EXPECT_EQ(scheduler.BatchRows(), 40);
+  EXPECT_EQ(scheduler.Interval().count(), 1000);
+
+  scheduler.OnSuccess(false);
+  scheduler.OnSuccess(false);
+  scheduler.OnSuccess(false);
+  EXPECT_EQ(scheduler.BatchRows(), 10);
+  EXPECT_EQ(scheduler.Interval().count(), 4000);
+}
+
+// 连续失败时指数退避，抖动后落在 [backoff/2, backoff] 之间
+TEST(ReportSchedulerTest, BackoffTest) {
+  buried::ReportSchedulerOptions options;
+  options.base_interval_ms = 1000;
+  options.max_backoff_ms = 8000;
+  buried::ReportScheduler scheduler(options);
+  scheduler.OnSuccess(true);
+
+  uint32_t expected[] = {1000, 2000, 4000, 8000, 8000};
+  for (uint32_t backoff : expected) {
+    scheduler.OnCycle();
+    scheduler.OnFailure();
+    EXPECT_EQ(scheduler.BatchRows(), options.min_batch_rows);
+    EXPECT_GE(scheduler.Interval().count(),
+              std::max(backoff / 2, options.base_interval_ms));
+    EXPECT_LE(scheduler.Interval().count(), backoff);
+  }
+
+  scheduler.OnSuccess(false);
+  EXPECT_EQ(scheduler.Interval().count(), 1000);
+}
+
+// 同一周期内窗口中的多个批次失败只算一次失败
+TEST(ReportSchedulerTest, WindowFailureTest) {
+  buried::ReportSchedulerOptions options;
+  options.base_interval_ms = 1000;
+  options.max_backoff_ms = 64000;
+  buried::ReportScheduler scheduler(options);
+
+  scheduler.OnCycle();
+  for (int i = 0; i < 4; ++i) {
+    scheduler.OnFailure();
+  }
+  EXPECT_EQ(scheduler.Interval().count(), 1000);
+
+  scheduler.OnCycle();
+  scheduler.OnFailure();
+  scheduler.OnFailure();
+  EXPECT_GE(scheduler.Interval().count(), 1000);
+  EXPECT_LE(scheduler.Interval().count(), 2000);
+
+  // 有积压时恢复后从正常间隔开始减半
+  scheduler.OnSuccess(true);
+  EXPECT_EQ(scheduler.Interval().count(), 500);
+}
\ No newline at end of file
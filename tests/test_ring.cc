@@ -0,0 +1,166 @@
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/report/event_ring.h"
+
+struct RingItem {
+  uint32_t id = 0;
+  uint32_t priority = 0;
+  std::string payload;
+};
+
+// 基本的写入和批量取出
+TEST(EventRingTest, BasicTest) {
+  buried::EventRing<RingItem> ring(6, buried::OverflowPolicy::kDrop);
+  EXPECT_EQ(ring.Capacity(), 8);
+
+  for (uint32_t i = 0; i < 8; ++i) {
+    EXPECT_TRUE(ring.Push(RingItem{i, i, "hello"}));
+  }
+  EXPECT_EQ(ring.Size(), 8);
+
+  std::vector<RingItem> items;
+  EXPECT_EQ(ring.PopBatch(items, 5), 5);
+  EXPECT_EQ(ring.PopBatch(items, 5), 3);
+  EXPECT_EQ(ring.PopBatch(items, 5), 0);
+  for (uint32_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(items[i].id, i);
+    EXPECT_EQ(items[i].payload, "hello");
+  }
+}
+
+// 写满后丢弃新事件
+TEST(EventRingTest, DropTest) {
+  buried::EventRing<RingItem> ring(4, buried::OverflowPolicy::kDrop);
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.Push(RingItem{i, i}));
+  }
+  EXPECT_FALSE(ring.Push(RingItem{4, 4}));
+  EXPECT_EQ(ring.DroppedCount(), 1);
+}
+
+// 写满后只淘汰优先级更低的队首，其余事件保持先进先出
+TEST(EventRingTest, OverwriteLowestPriorityTest) {
+  buried::EventRing<RingItem> ring(
+      4, buried::OverflowPolicy::kOverwriteLowestPriority);
+  EXPECT_TRUE(ring.Push(RingItem{0, 1}));
+  EXPECT_TRUE(ring.Push(RingItem{1, 5}));
+  EXPECT_TRUE(ring.Push(RingItem{2, 0}));
+  EXPECT_TRUE(ring.Push(RingItem{3, 5}));
+
+  EXPECT_TRUE(ring.Push(RingItem{4, 3}));
+  // 队首优先级不低于新事件（包括相等）时丢弃新事件，队列中的事件不动
+  EXPECT_FALSE(ring.Push(RingItem{5, 5}));
+  EXPECT_FALSE(ring.Push(RingItem{6, 3}));
+  EXPECT_EQ(ring.DroppedCount(), 3);
+
+  std::vector<RingItem> items;
+  EXPECT_EQ(ring.PopBatch(items, 10), 4);
+  std::vector<uint32_t> ids;
+  for (const auto& item : items) {
+    ids.push_back(item.id);
+  }
+  EXPECT_EQ(ids, (std::vector<uint32_t>{1, 2, 3, 4}));
+}
+
+// 多生产者并发写入，单消费者取出，事件不丢不重
+TEST(EventRingTest, MultiProducerTest) {
+  static constexpr uint32_t kProducers = 4;
+  static constexpr uint32_t kPerProducer = 10000;
+  buried::EventRing<RingItem> ring(256, buried::OverflowPolicy::kBlock);
+
+  std::vector<std::thread> producers;
+  for (uint32_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&ring, p]() {
+      for (uint32_t i = 0; i < kPerProducer; ++i) {
+        ring.Push(RingItem{p * kPerProducer + i, 0});
+      }
+    });
+  }
+
+  std::vector<bool> seen(kProducers * kPerProducer, false);
+  size_t total = 0;
+  std::vector<RingItem> items;
+  while (total < seen.size()) {
+    items.clear();
+    total += ring.PopBatch(items, 64);
+    for (const auto& item : items) {
+      EXPECT_FALSE(seen[item.id]);
+      seen[item.id] = true;
+    }
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  EXPECT_EQ(ring.DroppedCount(), 0);
+  EXPECT_EQ(ring.Size(), 0);
+}
+
+// 批量写入：空间足够时整批连续写入，不足时按溢出策略逐个写入
+TEST(EventRingTest, PushBulkTest) {
+  buried::EventRing<RingItem> ring(8, buried::OverflowPolicy::kDrop);
+  std::vector<RingItem> batch;
+  for (uint32_t i = 0; i < 6; ++i) {
+    batch.push_back(RingItem{i, i, "bulk"});
+  }
+  EXPECT_EQ(ring.PushBulk(batch.data(), batch.size()), 6);
+  EXPECT_EQ(ring.Size(), 6);
+
+  std::vector<RingItem> more;
+  for (uint32_t i = 6; i < 10; ++i) {
+    more.push_back(RingItem{i, i});
+  }
+  EXPECT_EQ(ring.PushBulk(more.data(), more.size()), 2);
+  EXPECT_EQ(ring.DroppedCount(), 2);
+
+  std::vector<RingItem> items;
+  EXPECT_EQ(ring.PopBatch(items, 10), 8);
+  for (uint32_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(items[i].id, i);
+  }
+  EXPECT_EQ(items[0].payload, "bulk");
+}
+
+// 多生产者并发批量写入，每一批在队列中保持连续
+TEST(EventRingTest, MultiProducerBulkTest) {
+  static constexpr uint32_t kProducers = 4;
+  static constexpr uint32_t kBatches = 500;
+  static constexpr uint32_t kBatchSize = 8;
+  buried::EventRing<RingItem> ring(64, buried::OverflowPolicy::kBlock);
+
+  std::vector<std::thread> producers;
+  for (uint32_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&ring, p]() {
+      std::vector<RingItem> batch(kBatchSize);
+      for (uint32_t b = 0; b < kBatches; ++b) {
+        for (uint32_t i = 0; i < kBatchSize; ++i) {
+          batch[i] = RingItem{(p * kBatches + b) * kBatchSize + i, 0};
+        }
+        ring.PushBulk(batch.data(), batch.size());
+      }
+    });
+  }
+
+  std::vector<RingItem> items;
+  size_t expected = kProducers * kBatches * kBatchSize;
+  while (items.size() < expected) {
+    ring.PopBatch(items, 64);
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  std::vector<bool> seen(expected, false);
+  for (size_t i = 0; i < items.size(); ++i) {
+    EXPECT_FALSE(seen[items[i].id]);
+    seen[items[i].id] = true;
+    if (items[i].id % kBatchSize != 0) {
+      EXPECT_EQ(items[i].id, items[i - 1].id + 1);
+    }
+  }
+  EXPECT_EQ(ring.DroppedCount(), 0);
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "src/report/row_codec.h"
+#include "src/report/string_dictionary.h"
+#include "src/third_party/nlohmann/json.hpp"
+
+static buried::RowEvent MakeEvent() {
+  buried::RowEvent event;
+  event.title = "click";
+  event.data = "line\n \"quoted\" 中文";
+  event.priority = 3;
+  event.timestamp = 1700000000123;
+  event.process_time = "2026-01-01 00:00:00.000";
+  event.report_id = "0123456789abcdefghijABCDEFGHIJ01";
+  return event;
+}
+
+// 边界值的 varint 编码可以还原，截断的输入被拒绝
+TEST(RowCodecTest, VarintTest) {
+  for (uint64_t value : {uint64_t{0}, uint64_t{127}, uint64_t{128},
+                         uint64_t{300}, std::numeric_limits<uint64_t>::max()}) {
+    std::string out;
+    buried::PutVarint(out, value);
+    std::string_view in = out;
+    uint64_t decoded = 0;
+    EXPECT_TRUE(buried::GetVarint(in, decoded));
+    EXPECT_EQ(decoded, value);
+    EXPECT_TRUE(in.empty());
+
+    std::string_view truncated(out.data(), out.size() - 1);
+    EXPECT_FALSE(buried::GetVarint(truncated, decoded));
+  }
+}
+
+// 编码后可以还原各个字段，时间差可以为负
+TEST(RowCodecTest, RoundTripTest) {
+  buried::RowEvent event = MakeEvent();
+  std::string row;
+  buried::EncodeRow(event, event.timestamp + 5, row);
+  EXPECT_FALSE(buried::IsJsonRow(row));
+
+  buried::RowEvent decoded;
+  ASSERT_TRUE(buried::DecodeRow(row, event.timestamp + 5, decoded));
+  EXPECT_EQ(decoded.flags, event.flags);
+  EXPECT_EQ(decoded.title, event.title);
+  EXPECT_EQ(decoded.data, event.data);
+  EXPECT_EQ(decoded.priority, event.priority);
+  EXPECT_EQ(decoded.timestamp, event.timestamp);
+  EXPECT_EQ(decoded.process_time, event.process_time);
+  EXPECT_EQ(decoded.report_id, event.report_id);
+
+  // 任意位置截断都应解码失败
+  for (size_t size = 0; size < row.size(); ++size) {
+    EXPECT_FALSE(buried::DecodeRow(std::string_view(row.data(), size),
+                                   event.timestamp, decoded));
+  }
+}
+
+// 二进制行转换成的 JSON 和旧格式的字段一致，旧格式原样保留
+TEST(RowCodecTest, JsonTest) {
+  buried::RowEvent event = MakeEvent();
+  std::string row;
+  buried::EncodeRow(event, event.timestamp, row);
+
+  buried::RowJsonWriter writer;
+  std::string out;
+  ASSERT_TRUE(writer.Append(row, event.timestamp, out));
+  auto json = nlohmann::json::parse(out);
+  EXPECT_EQ(json["title"], "click");
+  EXPECT_EQ(json["data"], std::string(event.data));
+  EXPECT_EQ(json["priority"], 3);
+  EXPECT_EQ(json["process_time"], std::string(event.process_time));
+  EXPECT_EQ(json["report_id"], std::string(event.report_id));
+  EXPECT_GT(json["timestamp"].get<std::string>().size(), 0);
+
+  event.flags = buried::kRowDataIsJson;
+  event.data = "{\"count\":1}";
+  row.clear();
+  buried::EncodeRow(event, event.timestamp, row);
+  out.clear();
+  ASSERT_TRUE(writer.Append(row, event.timestamp, out));
+  EXPECT_EQ(nlohmann::json::parse(out)["data"]["count"], 1);
+
+  std::string legacy = "{\"title\":\"old\",\"data\":\"\"}";
+  out.clear();
+  ASSERT_TRUE(writer.Append(legacy, 0, out));
+  EXPECT_EQ(out, legacy);
+
+  out = "keep";
+  EXPECT_FALSE(writer.Append(std::string("\x7f", 1), 0, out));
+  EXPECT_EQ(out, "keep");
+}
+
+// 二进制行明显小于同样字段的 JSON
+TEST(RowCodecTest, SizeTest) {
+  buried::RowEvent event = MakeEvent();
+  std::string row;
+  buried::EncodeRow(event, event.timestamp, row);
+
+  buried::RowJsonWriter writer;
+  std::string json;
+  ASSERT_TRUE(writer.Append(row, event.timestamp, json));
+  EXPECT_LT(row.size() + 64, json.size());
+}
+
+// 字典中的字符串只保存 id，解码时需要同一个字典
+TEST(RowCodecTest, DictionaryTest) {
+  buried::StringDictionary dictionary;
+  buried::RowEvent event = MakeEvent();
+  std::string inline_row;
+  buried::EncodeRow(event, event.timestamp, inline_row);
+
+  event.title_id = dictionary.Intern(event.title);
+  event.process_time_id = dictionary.Intern(event.process_time);
+  std::string row;
+  buried::EncodeRow(event, event.timestamp, row);
+  // 每个字符串从 引用 0 + 长度 + 内容 变为一个字节的 id
+  EXPECT_EQ(inline_row.size() - row.size(),
+            event.title.size() + event.process_time.size() + 2);
+
+  buried::RowEvent decoded;
+  EXPECT_FALSE(buried::DecodeRow(row, event.timestamp, decoded));
+  ASSERT_TRUE(
+      buried::DecodeRow(row, event.timestamp, decoded, &dictionary));
+  EXPECT_EQ(decoded.title_id, event.title_id);
+  EXPECT_EQ(decoded.title, event.title);
+  EXPECT_EQ(decoded.process_time, event.process_time);
+
+  // 默认展开为字符串
+  buried::RowJsonWriter writer(&dictionary);
+  std::string out;
+  ASSERT_TRUE(writer.Append(row, event.timestamp, out));
+  EXPECT_EQ(nlohmann::json::parse(out)["title"], "click");
+
+  // 上报时使用 id，字典单独附带
+  buried::RowJsonWriter wire_writer(&dictionary, true);
+  out.clear();
+  ASSERT_TRUE(wire_writer.Append(row, event.timestamp, out));
+  auto json = nlohmann::json::parse(out);
+  EXPECT_EQ(json["title_id"], event.title_id);
+  EXPECT_EQ(json["process_time_id"], event.process_time_id);
+  EXPECT_FALSE(json.contains("title"));
+
+  std::string strings;
+  wire_writer.AppendStrings(strings);
+  auto table = nlohmann::json::parse(strings);
+  EXPECT_EQ(table[std::to_string(event.title_id)], "click");
+  EXPECT_EQ(table.size(), 2);
+
+  wire_writer.Reset();
+  strings.clear();
+  wire_writer.AppendStrings(strings);
+  EXPECT_EQ(strings, "{}");
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/report/string_dictionary.h"
+
+TEST(StringDictionaryTest, InternTest) {
+  buried::StringDictionary dictionary;
+  EXPECT_EQ(dictionary.Find("click"), 0);
+
+  uint32_t click = dictionary.Intern("click");
+  uint32_t view = dictionary.Intern("view");
+  EXPECT_EQ(click, 1);
+  EXPECT_EQ(view, 2);
+  EXPECT_EQ(dictionary.Intern("click"), click);
+  EXPECT_EQ(dictionary.Find("view"), view);
+
+  std::string_view value;
+  EXPECT_TRUE(dictionary.Lookup(view, value));
+  EXPECT_EQ(value, "view");
+  EXPECT_FALSE(dictionary.Lookup(0, value));
+  EXPECT_FALSE(dictionary.Lookup(3, value));
+
+  // 新分配的条目只取出一次
+  auto unsaved = dictionary.TakeUnsaved();
+  ASSERT_EQ(unsaved.size(), 2);
+  EXPECT_EQ(unsaved[0].first, click);
+  EXPECT_EQ(unsaved[0].second, "click");
+  EXPECT_TRUE(dictionary.TakeUnsaved().empty());
+}
+
+// 加载的条目不需要再保存，新条目的 id 排在已加载条目之后
+TEST(StringDictionaryTest, LoadTest) {
+  buried::StringDictionary dictionary;
+  dictionary.Load(1, "click");
+  dictionary.Load(3, "view");
+  EXPECT_EQ(dictionary.Find("click"), 1);
+  EXPECT_EQ(dictionary.Find("view"), 3);
+  EXPECT_TRUE(dictionary.TakeUnsaved().empty());
+
+  // 空位不是条目
+  std::string_view value;
+  EXPECT_FALSE(dictionary.Lookup(2, value));
+  EXPECT_TRUE(dictionary.Lookup(3, value));
+  EXPECT_EQ(value, "view");
+
+  EXPECT_EQ(dictionary.Intern("scroll"), 4);
+  EXPECT_EQ(dictionary.TakeUnsaved().size(), 1);
+}
+
+// 无法读取的条目只占住 id，不能查到，也不会分配给新字符串
+TEST(StringDictionaryTest, ReserveTest) {
+  buried::StringDictionary dictionary;
+  dictionary.Load(1, "click");
+  dictionary.Reserve(2);
+  std::string_view value;
+  EXPECT_FALSE(dictionary.Lookup(2, value));
+  EXPECT_EQ(dictionary.Find(""), 0);
+  EXPECT_EQ(dictionary.Intern("view"), 3);
+  EXPECT_TRUE(dictionary.Lookup(3, value));
+  EXPECT_EQ(value, "view");
+}
+
+// 写满后不再分配新 id
+TEST(StringDictionaryTest, LimitTest) {
+  buried::StringDictionary dictionary(2);
+  EXPECT_EQ(dictionary.Intern("a"), 1);
+  EXPECT_EQ(dictionary.Intern("b"), 2);
+  EXPECT_EQ(dictionary.Intern("c"), 0);
+  EXPECT_EQ(dictionary.Intern("a"), 1);
+  EXPECT_EQ(dictionary.Size(), 2);
+}
+
+// 多个线程同时分配同一组字符串，每个字符串只有一个 id
+TEST(StringDictionaryTest, ConcurrentTest) {
+  buried::StringDictionary dictionary;
+  static constexpr int kThreads = 4;
+  static constexpr int kWords = 100;
+  std::vector<std::vector<uint32_t>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&dictionary, &ids, t]() {
+      for (int i = 0; i < kWords; ++i) {
+        ids[t].push_back(dictionary.Intern("word" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(dictionary.Size(), kWords);
+  for (int t = 1; t < kThreads; ++t) {
+    EXPECT_EQ(ids[t], ids[0]);
+  }
+  EXPECT_EQ(dictionary.TakeUnsaved().size(), kWords);
+}
\ No newline at end of file